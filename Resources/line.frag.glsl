@@ -1,9 +1,9 @@
 #version 330 core
 
-out vec4 frag_Color;
+in vec4 vert_Color;
 
-uniform vec4 color;
+out vec4 frag_Color;
 
 void main(void) {
-	frag_Color = color;
-}
\ No newline at end of file
+	frag_Color = vert_Color;
+}
@@ -0,0 +1,47 @@
+#version 330 core
+
+layout(location = 0) in vec2 vert_Position;
+
+// per instance
+layout(location = 1) in vec2 inst_Location;
+layout(location = 2) in float inst_Rotation;
+layout(location = 3) in vec2 inst_RotationCenter;
+layout(location = 4) in float inst_Scale;
+layout(location = 5) in vec4 inst_Color;
+
+layout(std140) uniform Frame {
+	vec2 screenDimensions;
+	vec3 cameraParams;
+};
+
+out vec4 vert_Color;
+
+void main(void) {
+	// set the position	
+	gl_Position = vec4(vert_Position, 0.0, 1.0);
+	
+	// apply the rotation
+	if (inst_Rotation != 0) {
+		float s = sin(inst_Rotation);
+		float c = cos(inst_Rotation);
+		gl_Position.xy = inst_RotationCenter + (mat2(c, -s, s, c) * (gl_Position.xy - inst_RotationCenter));
+	}
+	
+	// scale correctly
+	gl_Position.xy *= inst_Scale;
+	gl_Position.xy /= 12.0;
+	
+	// move according to the position in the level
+	gl_Position.x += (inst_Location.x / 24.0) * 2;
+	gl_Position.y -= (inst_Location.y / 24.0) * 2;
+
+	// apply the camera
+	gl_Position.x -= cameraParams.x / 12.0;
+	gl_Position.y += cameraParams.y / 12.0;
+	gl_Position.xy *= cameraParams.z;
+	
+	// scale to correct resolution
+	gl_Position.x *= screenDimensions.y / screenDimensions.x;
+
+	vert_Color = inst_Color;
+}
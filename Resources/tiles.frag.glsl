@@ -0,0 +1,40 @@
+#version 330 core
+
+in vec2 vert_Position;
+
+out vec4 frag_Color;
+
+// one texel per tile, red is 1 for solid tiles
+uniform sampler2D tiles;
+uniform vec4 color;
+
+void main(void) {
+	// the tile this fragment is in, and the position within it
+	vec2 tile = vec2(floor(vert_Position.x), floor(-vert_Position.y) + 1.0);
+	vec2 local = vec2(fract(vert_Position.x), 1.0 - fract(-vert_Position.y));
+
+	ivec2 size = textureSize(tiles, 0);
+	if (tile.x < 0 || tile.y < 0 || tile.x >= size.x || tile.y >= size.y) {
+		discard;
+	}
+
+	if (texelFetch(tiles, ivec2(tile), 0).r < 0.5) {
+		discard;
+	}
+
+	// signed distance to the bevelled outline of a wall
+	const float s = 0.70710678;
+	float d = max(
+			max(max(0.05 - local.x, local.x - 0.95), max(0.05 - local.y, local.y - 0.95)),
+			max(
+				max((0.15 - local.x - local.y) * s, (local.x - local.y - 0.85) * s),
+				max((local.x + local.y - 1.85) * s, (local.y - local.x - 0.85) * s)));
+
+	// draw the outline a pixel wide
+	float pixel = max(fwidth(vert_Position.x), fwidth(vert_Position.y));
+	if (abs(d) > 0.5 * pixel) {
+		discard;
+	}
+
+	frag_Color = color;
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+layout(std140) uniform Frame {
+	vec2 screenDimensions;
+	vec3 cameraParams;
+};
+
+// the position in the level, in the units of the line art
+out vec2 vert_Position;
+
+void main(void) {
+	// a quad covering the screen
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+	gl_Position = vec4(corner, 0.0, 1.0);
+
+	// undo the camera of the line shader
+	vec2 position = corner;
+	position.x *= screenDimensions.x / screenDimensions.y;
+	position /= cameraParams.z;
+	position *= 12.0;
+	position.x += cameraParams.x;
+	position.y -= cameraParams.y;
+
+	vert_Position = position;
+}
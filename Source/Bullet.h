@@ -5,36 +5,26 @@
 #ifndef BULLET_H_
 #define BULLET_H_
 
-#include "Entity.h"
+#include <glm/glm.hpp>
 
-class Bullet : public Entity {
+#include "LineBatch.h"
 
-public:
-	Bullet(float x, float y, float vx, float vy, const glm::vec4& color, float scale, bool following, bool exploding);
-
-	void Render(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) const;
-	void InternalUpdate(float dt, Level& level);
-
-	void OnCollisionStart(Entity *other, b2Contact *contact);
+/**
+ * The size and look of a bullet. Bullets have no entity or body of their
+ * own, they are simulated by a BulletSystem, and drawn with Draw() by it
+ * and by the player holding one.
+ */
+class Bullet {
 
-protected:
-	b2BodyDef _CreateBody() const;
-	void _CreateFixture(std::shared_ptr<b2Body> body) const;
+public:
+	static constexpr float radius = 0.15f;
 
-private:
-	float _start_vx;
-	float _start_vy;
-	glm::vec4 _color;
-	float _scale;
-	bool _following;
-	bool _exploding;
+	static void Draw(LineBatch& batch, const glm::vec2& position, const glm::vec4& color, float scale);
 
 private:
 	static void _PrepareRenderer();
 
-	static GLhandle _vao;
-	static GLhandle _vbo;
-	static unsigned _count;
+	static LineBatch::Mesh _mesh;
 	static bool _is_renderer_prepared;
 
 };
@@ -0,0 +1,510 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "BulletSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define BULLETSYSTEM_SSE
+#include <emmintrin.h>
+#endif
+
+#include "Bullet.h"
+#include "Level.h"
+
+namespace {
+
+/*
+ * Moves a bullet along one axis from 'from' to 'to', with 'other' its
+ * coordinate on the other axis. When it crosses a face of a solid tile,
+ * grown by the bullet radius, it is stopped at that face.
+ */
+bool SweepAxis(const TileMap& tiles, bool horizontal, float from, float& to, float other) {
+	const float extent = 0.45f + Bullet::radius;
+
+	int first = int(std::ceil(other - extent));
+	int last = int(std::floor(other + extent));
+
+	auto isSolid = [&](int i) {
+		for (int j = first; j <= last; j++) {
+			if (horizontal ? tiles.IsSolid(i, j) : tiles.IsSolid(j, i)) {
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	auto stop = [&](float face) {
+		to = face;
+		return true;
+	};
+
+	if (to > from) {
+		for (int i = int(std::ceil(from + extent)); i <= int(std::floor(to + extent)); i++) {
+			if (isSolid(i)) {
+				return stop(i - extent);
+			}
+		}
+	} else if (to < from) {
+		for (int i = int(std::floor(from - extent)); i >= int(std::ceil(to - extent)); i--) {
+			if (isSolid(i)) {
+				return stop(i + extent);
+			}
+		}
+	}
+
+	return false;
+}
+
+}
+
+template<typename Function>
+void BulletSystem::_ForEachInCircle(const glm::vec2& center, float radius, Function function) const {
+	size_t i = 0;
+
+#ifdef BULLETSYSTEM_SSE
+	__m128 cx = _mm_set1_ps(center.x);
+	__m128 cy = _mm_set1_ps(center.y);
+	__m128 r2 = _mm_set1_ps(radius * radius);
+
+	for (; i + 4 <= Size(); i += 4) {
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(&_x[i]), cx);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(&_y[i]), cy);
+		__m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+		for (int mask = _mm_movemask_ps(_mm_cmple_ps(d2, r2)), k = 0; mask; mask >>= 1, k++) {
+			if (mask & 1) {
+				function(i + k);
+			}
+		}
+	}
+#endif
+
+	for (; i < Size(); i++) {
+		float dx = _x[i] - center.x;
+		float dy = _y[i] - center.y;
+
+		if (dx * dx + dy * dy <= radius * radius) {
+			function(i);
+		}
+	}
+}
+
+template<typename Function>
+void BulletSystem::_ForEachInBox(const glm::vec2& lower, const glm::vec2& upper, float margin, Function function) const {
+	size_t i = 0;
+
+#ifdef BULLETSYSTEM_SSE
+	__m128 zero = _mm_setzero_ps();
+	__m128 lx = _mm_set1_ps(lower.x);
+	__m128 ly = _mm_set1_ps(lower.y);
+	__m128 ux = _mm_set1_ps(upper.x);
+	__m128 uy = _mm_set1_ps(upper.y);
+	__m128 m2 = _mm_set1_ps(margin * margin);
+
+	for (; i + 4 <= Size(); i += 4) {
+		__m128 x = _mm_loadu_ps(&_x[i]);
+		__m128 y = _mm_loadu_ps(&_y[i]);
+
+		// distance from the box on each axis, zero inside
+		__m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(lx, x), _mm_sub_ps(x, ux)), zero);
+		__m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(ly, y), _mm_sub_ps(y, uy)), zero);
+		__m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+		for (int mask = _mm_movemask_ps(_mm_cmple_ps(d2, m2)), k = 0; mask; mask >>= 1, k++) {
+			if (mask & 1) {
+				function(i + k);
+			}
+		}
+	}
+#endif
+
+	for (; i < Size(); i++) {
+		float dx = std::max(std::max(lower.x - _x[i], _x[i] - upper.x), 0.0f);
+		float dy = std::max(std::max(lower.y - _y[i], _y[i] - upper.y), 0.0f);
+
+		if (dx * dx + dy * dy <= margin * margin) {
+			function(i);
+		}
+	}
+}
+
+BulletSystem::BulletSystem(const glm::vec4& color, bool following) :
+		_color(color), _following(following) {}
+
+void BulletSystem::Spawn(float x, float y, float vx, float vy, bool exploding) {
+	_x.push_back(x);
+	_y.push_back(y);
+	_vx.push_back(vx);
+	_vy.push_back(vy);
+	_previous_x.push_back(x);
+	_previous_y.push_back(y);
+	_flags.push_back(exploding ? EXPLODING : 0);
+	_sequence.push_back(_next_sequence++);
+}
+
+void BulletSystem::SetActivityRegion(const glm::vec2& lower, const glm::vec2& upper) {
+	_activity_lower = lower;
+	_activity_upper = upper;
+}
+
+void BulletSystem::Update(float dt, Level& level, const TileMap& tiles, const std::vector<Entity *>& targets, CommandBuffer& commands) {
+	_Integrate(dt);
+
+	if (_following) {
+		_Steer(level);
+	}
+
+	_CollideTiles(tiles, commands);
+	_CollideTargets(targets, commands);
+}
+
+void BulletSystem::CollideWith(BulletSystem& other, CommandBuffer& commands) {
+	for (size_t i = 0; i < Size(); i++) {
+		if (_flags[i] & (DEAD | DORMANT)) {
+			continue;
+		}
+
+		other._ForEachInCircle({ _x[i], _y[i] }, 2.0f * Bullet::radius, [&](size_t j) {
+			if (!(other._flags[j] & (DEAD | DORMANT)) && !(_flags[i] & DEAD)) {
+				_Hit(i, commands);
+				other._Hit(j, commands);
+			}
+		});
+	}
+}
+
+void BulletSystem::KillWithin(const glm::vec2& center, float radius) {
+	_ForEachInCircle(center, radius, [this](size_t i) {
+		_flags[i] |= DEAD;
+	});
+}
+
+void BulletSystem::RemoveDead() {
+	// swap-and-pop, like EntityStorage::RemoveDead
+	for (size_t i = 0; i < Size();) {
+		if (!(_flags[i] & DEAD)) {
+			i++;
+			continue;
+		}
+
+		size_t last = Size() - 1;
+		_x[i] = _x[last];
+		_y[i] = _y[last];
+		_vx[i] = _vx[last];
+		_vy[i] = _vy[last];
+		_previous_x[i] = _previous_x[last];
+		_previous_y[i] = _previous_y[last];
+		_flags[i] = _flags[last];
+		_sequence[i] = _sequence[last];
+
+		_x.pop_back();
+		_y.pop_back();
+		_vx.pop_back();
+		_vy.pop_back();
+		_previous_x.pop_back();
+		_previous_y.pop_back();
+		_flags.pop_back();
+		_sequence.pop_back();
+	}
+}
+
+size_t BulletSystem::MergeDistant(const glm::vec2& center, float distance, float cellSize, const TileMap& tiles) {
+	_merge_cells.clear();
+	_merge_sums.clear();
+	_scratch.clear();
+
+	// sum the bullets of each cell
+	for (size_t i = 0; i < Size(); i++) {
+		float dx = _x[i] - center.x;
+		float dy = _y[i] - center.y;
+
+		if ((_flags[i] & DEAD) || dx * dx + dy * dy <= distance * distance) {
+			continue;
+		}
+
+		uint64_t cell = (uint64_t(uint32_t(int32_t(std::floor(_x[i] / cellSize)))) << 32)
+				| uint32_t(int32_t(std::floor(_y[i] / cellSize)));
+
+		auto inserted = _merge_cells.emplace(cell, uint32_t(_merge_sums.size()));
+
+		if (inserted.second) {
+			_merge_sums.push_back({ uint32_t(i), 0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0 });
+		}
+
+		_MergeCell& sum = _merge_sums[inserted.first->second];
+		sum.count++;
+		sum.x += _x[i];
+		sum.y += _y[i];
+		sum.vx += _vx[i];
+		sum.vy += _vy[i];
+		sum.speed += std::sqrt(_vx[i] * _vx[i] + _vy[i] * _vy[i]);
+		sum.flags |= _flags[i] & EXPLODING;
+
+		// pairs of the cell and the bullet
+		_scratch.push_back(inserted.first->second);
+		_scratch.push_back(uint32_t(i));
+	}
+
+	// move the first bullet of each cell to the average
+	for (_MergeCell& sum : _merge_sums) {
+		if (sum.count < 2) {
+			continue;
+		}
+
+		float x = sum.x / sum.count;
+		float y = sum.y / sum.count;
+
+		if (tiles.IsSolid(int(std::round(x)), int(std::round(y)))) {
+			sum.count = 1;
+			continue;
+		}
+
+		// bullets flying in opposite directions cancel out, the merged
+		// bullet keeps the direction of the first one then
+		float length = std::sqrt(sum.vx * sum.vx + sum.vy * sum.vy);
+		float speed = sum.speed / sum.count;
+		uint32_t j = sum.first;
+
+		if (length > 1e-4f) {
+			_vx[j] = sum.vx / length * speed;
+			_vy[j] = sum.vy / length * speed;
+		} else {
+			float first = std::sqrt(_vx[j] * _vx[j] + _vy[j] * _vy[j]);
+
+			if (first > 0.0f) {
+				_vx[j] *= speed / first;
+				_vy[j] *= speed / first;
+			}
+		}
+
+		_x[j] = x;
+		_y[j] = y;
+		_previous_x[j] = x;
+		_previous_y[j] = y;
+		_flags[j] |= sum.flags;
+	}
+
+	// and remove the others
+	size_t merged = 0;
+
+	for (size_t k = 0; k < _scratch.size(); k += 2) {
+		const _MergeCell& sum = _merge_sums[_scratch[k]];
+		uint32_t i = _scratch[k + 1];
+
+		if (sum.count >= 2 && i != sum.first) {
+			_flags[i] |= DEAD;
+			merged++;
+		}
+	}
+
+	return merged;
+}
+
+size_t BulletSystem::RecycleOldest(size_t count) {
+	_scratch.clear();
+
+	for (size_t i = 0; i < Size(); i++) {
+		if (!(_flags[i] & DEAD)) {
+			_scratch.push_back(i);
+		}
+	}
+
+	count = std::min(count, _scratch.size());
+
+	if (count < _scratch.size()) {
+		std::nth_element(_scratch.begin(), _scratch.begin() + count, _scratch.end(), [this](uint32_t a, uint32_t b) {
+			return _sequence[a] < _sequence[b];
+		});
+	}
+
+	for (size_t k = 0; k < count; k++) {
+		_flags[_scratch[k]] |= DEAD;
+	}
+
+	return count;
+}
+
+size_t BulletSystem::AliveCount() const {
+	return std::count_if(_flags.begin(), _flags.end(), [](uint8_t flags) {
+		return !(flags & DEAD);
+	});
+}
+
+void BulletSystem::Render(LineBatch& batch, float alpha) const {
+	// dormant bullets are outside the activity region, which should be
+	// larger than the view, so they are off screen
+	for (size_t i = 0; i < Size(); i++) {
+		if (_flags[i] & (DEAD | DORMANT)) {
+			continue;
+		}
+
+		glm::vec2 position {
+			_previous_x[i] + (_x[i] - _previous_x[i]) * alpha,
+			_previous_y[i] + (_y[i] - _previous_y[i]) * alpha
+		};
+
+		Bullet::Draw(batch, position, _color, 1.0f);
+	}
+}
+
+void BulletSystem::_Steer(Level& level) {
+	Player& player = level.GetPlayer();
+	const FlowField& field = level.GetFlowField();
+	const VisibilityGrid& visibility = level.GetVisibility();
+
+	for (size_t i = 0; i < Size(); i++) {
+		if (_flags[i] & (DEAD | DORMANT)) {
+			continue;
+		}
+
+		// aim at the player when it is in sight, and follow the flow field
+		// around the walls otherwise
+		glm::vec2 delta { player.X() - _x[i], player.Y() - _y[i] };
+
+		if (!visibility.IsVisible(_x[i], _y[i])) {
+			glm::vec2 flow;
+			float distance;
+
+			if (!field.Sample(_x[i], _y[i], flow, distance)) {
+				continue;
+			}
+
+			if (distance > 0.0f) {
+				delta = { flow.x * distance, flow.y * distance };
+			}
+		}
+
+		float velocity = std::sqrt(_vx[i] * _vx[i] + _vy[i] * _vy[i]);
+		glm::vec2 direction { _vx[i] + delta.x * 0.1f, _vy[i] + delta.y * 0.1f };
+		float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+
+		if (length > 0.0f) {
+			_vx[i] = direction.x * velocity / length;
+			_vy[i] = direction.y * velocity / length;
+		}
+	}
+}
+
+void BulletSystem::_Integrate(float dt) {
+	// bullets outside the activity region don't move, and are marked dormant
+	size_t i = 0;
+
+#ifdef BULLETSYSTEM_SSE
+	__m128 step = _mm_set1_ps(dt);
+	__m128 lx = _mm_set1_ps(_activity_lower.x);
+	__m128 ly = _mm_set1_ps(_activity_lower.y);
+	__m128 ux = _mm_set1_ps(_activity_upper.x);
+	__m128 uy = _mm_set1_ps(_activity_upper.y);
+
+	for (; i + 4 <= Size(); i += 4) {
+		__m128 x = _mm_loadu_ps(&_x[i]);
+		__m128 y = _mm_loadu_ps(&_y[i]);
+
+		__m128 active = _mm_and_ps(
+				_mm_and_ps(_mm_cmpge_ps(x, lx), _mm_cmple_ps(x, ux)),
+				_mm_and_ps(_mm_cmpge_ps(y, ly), _mm_cmple_ps(y, uy)));
+		__m128 activeStep = _mm_and_ps(active, step);
+
+		_mm_storeu_ps(&_previous_x[i], x);
+		_mm_storeu_ps(&_previous_y[i], y);
+		_mm_storeu_ps(&_x[i], _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(&_vx[i]), activeStep)));
+		_mm_storeu_ps(&_y[i], _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(&_vy[i]), activeStep)));
+
+		int mask = _mm_movemask_ps(active);
+
+		for (int k = 0; k < 4; k++) {
+			_flags[i + k] = (mask >> k) & 1 ? _flags[i + k] & ~DORMANT : _flags[i + k] | DORMANT;
+		}
+	}
+#endif
+
+	for (; i < Size(); i++) {
+		bool active = _x[i] >= _activity_lower.x && _x[i] <= _activity_upper.x
+				&& _y[i] >= _activity_lower.y && _y[i] <= _activity_upper.y;
+
+		_previous_x[i] = _x[i];
+		_previous_y[i] = _y[i];
+
+		if (active) {
+			_x[i] += _vx[i] * dt;
+			_y[i] += _vy[i] * dt;
+			_flags[i] &= ~DORMANT;
+		} else {
+			_flags[i] |= DORMANT;
+		}
+	}
+}
+
+void BulletSystem::_CollideTiles(const TileMap& tiles, CommandBuffer& commands) {
+	for (size_t i = 0; i < Size(); i++) {
+		if (_flags[i] & (DEAD | DORMANT)) {
+			continue;
+		}
+
+		// move horizontally first, then vertically from there, a bullet
+		// touching a tile dies, so it doesn't need to move on
+		if (SweepAxis(tiles, true, _previous_x[i], _x[i], _previous_y[i])) {
+			_y[i] = _previous_y[i];
+			_Hit(i, commands);
+		} else if (SweepAxis(tiles, false, _previous_y[i], _y[i], _x[i])) {
+			_Hit(i, commands);
+		}
+	}
+}
+
+void BulletSystem::_CollideTargets(const std::vector<Entity *>& targets, CommandBuffer& commands) {
+	const float mass = float(M_PI) * Bullet::radius * Bullet::radius;
+
+	for (Entity *target : targets) {
+		// the bounds of all shapes of the body at its current transform
+		const b2Body *body = target->Body();
+		const b2Transform& transform = body->GetTransform();
+		b2AABB box;
+		box.lowerBound.Set(INFINITY, INFINITY);
+		box.upperBound.Set(-INFINITY, -INFINITY);
+
+		for (const b2Fixture *fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext()) {
+			const b2Shape *shape = fixture->GetShape();
+
+			for (int32 child = 0; child < shape->GetChildCount(); child++) {
+				b2AABB shapeBox;
+				shape->ComputeAABB(&shapeBox, transform, child);
+				box.lowerBound.Set(std::min(box.lowerBound.x, shapeBox.lowerBound.x), std::min(box.lowerBound.y, shapeBox.lowerBound.y));
+				box.upperBound.Set(std::max(box.upperBound.x, shapeBox.upperBound.x), std::max(box.upperBound.y, shapeBox.upperBound.y));
+			}
+		}
+
+		if (box.lowerBound.x > box.upperBound.x) {
+			continue;
+		}
+
+		_ForEachInBox({ box.lowerBound.x, box.lowerBound.y }, { box.upperBound.x, box.upperBound.y }, Bullet::radius, [&](size_t i) {
+			if (_flags[i] & (DEAD | DORMANT)) {
+				return;
+			}
+
+			target->ApplyImpulse({ _vx[i] * mass, _vy[i] * mass }, { _x[i], _y[i] });
+
+			if (target->GetType() == Entity::PLAYER) {
+				static_cast<Player *>(target)->HitByBullet(commands);
+			}
+
+			_Hit(i, commands);
+		});
+	}
+}
+
+void BulletSystem::_Hit(size_t i, CommandBuffer& commands) {
+	if (_flags[i] & EXPLODING) {
+		commands.Explode({ _x[i], _y[i] });
+		commands.ShakeScreen(15.0f, 0.5f);
+		commands.ShakeScreen(15.0f, 0.5f);
+	}
+
+	_flags[i] |= DEAD;
+}
@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef BULLETSYSTEM_H_
+#define BULLETSYSTEM_H_
+
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "CommandBuffer.h"
+#include "Entity.h"
+#include "TileMap.h"
+
+class Level;
+
+/**
+ * Simulates all bullets of one faction without Box2D. The bullets are
+ * stored as flat arrays, move in straight lines and hit the solid tiles of
+ * the level and the bodies they overlap. Every hit kills the bullet, or
+ * makes it explode.
+ */
+class BulletSystem {
+
+public:
+	BulletSystem(const glm::vec4& color, bool following);
+
+	void Spawn(float x, float y, float vx, float vy, bool exploding);
+
+	/**
+	 * Bullets outside the region are frozen in place by Update() until the
+	 * region covers them again.
+	 */
+	void SetActivityRegion(const glm::vec2& lower, const glm::vec2& upper);
+
+	/**
+	 * Steers, moves and collides all bullets. Targets are the bodies the
+	 * bullets can hit, a hit pushes the target and a hit player loses
+	 * health.
+	 */
+	void Update(float dt, Level& level, const TileMap& tiles, const std::vector<Entity *>& targets, CommandBuffer& commands);
+
+	/**
+	 * Hits every pair of overlapping bullets of this and the other system.
+	 */
+	void CollideWith(BulletSystem& other, CommandBuffer& commands);
+
+	void KillWithin(const glm::vec2& center, float radius);
+	void RemoveDead();
+
+	/**
+	 * Merges bullets farther than the distance from the center that share a
+	 * cell of the given size into one, at their average position, flying in
+	 * their average direction at their average speed. Cells whose average
+	 * position lies in a solid tile are left alone. Returns the number of
+	 * bullets removed.
+	 */
+	size_t MergeDistant(const glm::vec2& center, float distance, float cellSize, const TileMap& tiles);
+
+	/**
+	 * Kills the count oldest bullets, so their slots can be reused.
+	 * Returns the number of bullets killed.
+	 */
+	size_t RecycleOldest(size_t count);
+
+	size_t AliveCount() const;
+
+	void Render(LineBatch& batch, float alpha) const;
+
+	inline size_t Size() const { return _x.size(); }
+
+private:
+	enum _Flag : uint8_t {
+		EXPLODING = 1,
+		DEAD = 2,
+		DORMANT = 4
+	};
+
+	void _Steer(Level& level);
+	void _Integrate(float dt);
+	void _CollideTiles(const TileMap& tiles, CommandBuffer& commands);
+	void _CollideTargets(const std::vector<Entity *>& targets, CommandBuffer& commands);
+	void _Hit(size_t i, CommandBuffer& commands);
+
+	/*
+	 * Calls function(i) for every bullet whose center lies within the
+	 * radius around the center, or within the margin around the box.
+	 */
+	template<typename Function>
+	void _ForEachInCircle(const glm::vec2& center, float radius, Function function) const;
+	template<typename Function>
+	void _ForEachInBox(const glm::vec2& lower, const glm::vec2& upper, float margin, Function function) const;
+
+	const glm::vec4 _color;
+	const bool _following;
+
+	glm::vec2 _activity_lower { -INFINITY, -INFINITY };
+	glm::vec2 _activity_upper { INFINITY, INFINITY };
+
+	std::vector<float> _x;
+	std::vector<float> _y;
+	std::vector<float> _vx;
+	std::vector<float> _vy;
+	std::vector<float> _previous_x;
+	std::vector<float> _previous_y;
+	std::vector<uint8_t> _flags;
+
+	// spawn order, to find the oldest bullets
+	std::vector<uint64_t> _sequence;
+	uint64_t _next_sequence = 0;
+
+	// the sums of the bullets in a cell, for MergeDistant
+	struct _MergeCell {
+		uint32_t first;
+		uint32_t count;
+		float x, y;
+		float vx, vy;
+		float speed;
+		uint8_t flags;
+	};
+
+	// reused by MergeDistant and RecycleOldest
+	std::unordered_map<uint64_t, uint32_t> _merge_cells;
+	std::vector<_MergeCell> _merge_sums;
+	std::vector<uint32_t> _scratch;
+
+};
+
+#endif
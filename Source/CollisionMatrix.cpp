@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "CollisionMatrix.h"
+
+#include "Player.h"
+
+CollisionMatrix::CollisionMatrix() {
+	// the player stands on walls and shooters
+	_RegisterStart(Entity::PLAYER, Entity::WALL, Player::OnTouchWall);
+	_RegisterStart(Entity::PLAYER, Entity::SHOOTER, Player::OnTouchWall);
+	_RegisterEnd(Entity::PLAYER, Entity::WALL, Player::OnLeaveWall);
+	_RegisterEnd(Entity::PLAYER, Entity::SHOOTER, Player::OnLeaveWall);
+
+	// the player picks up diamonds, bullets are handled by the BulletSystem
+	_RegisterStart(Entity::PLAYER, Entity::DIAMOND, Player::OnTouchDiamond);
+}
+
+void CollisionMatrix::Dispatch(const ContactEvents& events, const EntityRegistry& registry, CommandBuffer& commands) const {
+	const std::vector<uint32_t>& order = events.Order();
+
+	for (size_t run = 0; run < order.size();) {
+		Entity::Type typeA = events.TypeA(order[run]);
+		Entity::Type typeB = events.TypeB(order[run]);
+
+		Handler startA = _start[typeA][typeB];
+		Handler startB = _start[typeB][typeA];
+		Handler endA = _end[typeA][typeB];
+		Handler endB = _end[typeB][typeA];
+
+		size_t k = run;
+
+		for (; k < order.size(); k++) {
+			uint32_t i = order[k];
+
+			if (events.TypeA(i) != typeA || events.TypeB(i) != typeB) {
+				break;
+			}
+
+			Entity *a = registry.Get(events.A(i));
+			Entity *b = registry.Get(events.B(i));
+
+			if (!a || !b) {
+				continue;
+			}
+
+			if (events.GetKind(i) == ContactEvents::BEGIN) {
+				if (startA) startA(*a, *b, events.ContactA(i), commands);
+				if (startB) startB(*b, *a, events.ContactB(i), commands);
+			} else {
+				if (endB) endB(*b, *a, events.ContactB(i), commands);
+				if (endA) endA(*a, *b, events.ContactA(i), commands);
+			}
+		}
+
+		run = k;
+	}
+}
+
+void CollisionMatrix::_RegisterStart(Entity::Type self, Entity::Type other, Handler handler) {
+	_start[self][other] = handler;
+}
+
+void CollisionMatrix::_RegisterEnd(Entity::Type self, Entity::Type other, Handler handler) {
+	_end[self][other] = handler;
+}
@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef COLLISIONMATRIX_H_
+#define COLLISIONMATRIX_H_
+
+#include "CommandBuffer.h"
+#include "ContactEvents.h"
+#include "EntityRegistry.h"
+#include "Entity.h"
+
+/**
+ * Looks up the collision responses of two entities by their types. A
+ * response is registered for an ordered (self, other) pair of types, and
+ * is called for the entity of the first type. Responses may change the
+ * state of the entities involved, but anything else has to go through the
+ * command buffer.
+ */
+class CollisionMatrix {
+
+public:
+	using Handler = void (*)(Entity& self, Entity& other, const ContactEvents::Contact& contact, CommandBuffer& commands);
+
+	/**
+	 * Builds the table with all the collision responses in the game.
+	 */
+	CollisionMatrix();
+
+	/**
+	 * Calls the responses for all events recorded during a physics step.
+	 * The events are handled in runs of the same pair of types, so the
+	 * responses for a run are only looked up once.
+	 */
+	void Dispatch(const ContactEvents& events, const EntityRegistry& registry, CommandBuffer& commands) const;
+
+private:
+	void _RegisterStart(Entity::Type self, Entity::Type other, Handler handler);
+	void _RegisterEnd(Entity::Type self, Entity::Type other, Handler handler);
+
+	Handler _start[Entity::TYPE_COUNT][Entity::TYPE_COUNT] = {};
+	Handler _end[Entity::TYPE_COUNT][Entity::TYPE_COUNT] = {};
+
+};
+
+#endif
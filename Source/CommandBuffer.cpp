@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "CommandBuffer.h"
+
+#include <cmath>
+
+#include "Level.h"
+
+void CommandBuffer::SpawnPlayerBullet(const EntityHandle& player, const glm::vec2& target, bool exploding) {
+	_Command command;
+	command.type = SPAWN_PLAYER_BULLET;
+	command.entity = player;
+	command.spawn = { target.x, target.y, exploding };
+	_commands.push_back(command);
+}
+
+void CommandBuffer::Explode(const glm::vec2& position) {
+	_Command command;
+	command.type = EXPLODE;
+	command.explode = { position.x, position.y };
+	_commands.push_back(command);
+}
+
+void CommandBuffer::ShakeScreen(float power, float amplitude) {
+	_Command command;
+	command.type = SHAKE_SCREEN;
+	command.shake = { power, amplitude };
+	_commands.push_back(command);
+}
+
+void CommandBuffer::Die(const EntityHandle& entity) {
+	_Command command;
+	command.type = DIE;
+	command.entity = entity;
+	_commands.push_back(command);
+}
+
+void CommandBuffer::Execute(Level& level) {
+	// executing may record new commands, so don't hold on to references
+	for (size_t i = 0; i < _commands.size(); i++) {
+		const _Command command = _commands[i];
+		Entity *entity = level.GetEntity(command.entity);
+
+		switch (command.type) {
+			case SPAWN_PLAYER_BULLET:
+				if (entity) {
+					b2Vec2 position = entity->Body()->GetPosition();
+
+					glm::vec2 direction { command.spawn.x, command.spawn.y };
+					direction.x -= position.x;
+					direction.y -= position.y - 0.5f;
+					direction /= sqrt(direction.x * direction.x + direction.y * direction.y);
+
+					level.SpawnPlayerBullet(
+							position.x + direction.x * 0.8f, position.y + direction.y * 0.8f,
+							direction.x * 10.0f, direction.y * 10.0f,
+							command.spawn.exploding);
+				}
+				break;
+			case EXPLODE:
+				level.ExplodeAt(command.explode.x, command.explode.y);
+				break;
+			case SHAKE_SCREEN:
+				level.ShakeScreen(command.shake.power, command.shake.amplitude);
+				break;
+			case DIE:
+				if (entity) {
+					entity->Die();
+				}
+				break;
+		}
+	}
+
+	_commands.clear();
+}
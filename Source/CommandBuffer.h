@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef COMMANDBUFFER_H_
+#define COMMANDBUFFER_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "EntityHandle.h"
+
+class Level;
+
+/**
+ * Collects gameplay actions that cannot be performed right away, for
+ * instance because the physics world is locked during a step. The commands
+ * are plain values, so recording one never allocates once the buffer has
+ * grown to its working size. All commands are executed together by
+ * Execute(), which keeps the storage for the next batch.
+ */
+class CommandBuffer {
+
+public:
+	/**
+	 * Spawns a player bullet from the player, towards the target.
+	 */
+	void SpawnPlayerBullet(const EntityHandle& player, const glm::vec2& target, bool exploding);
+
+	void Explode(const glm::vec2& position);
+
+	void ShakeScreen(float power, float amplitude);
+	void Die(const EntityHandle& entity);
+
+	/**
+	 * Executes and clears all recorded commands. Commands recorded during
+	 * the execution are executed as well.
+	 */
+	void Execute(Level& level);
+
+private:
+	enum _Type : uint8_t {
+		SPAWN_PLAYER_BULLET,
+		EXPLODE,
+		SHAKE_SCREEN,
+		DIE
+	};
+
+	struct _Command {
+		_Type type;
+		EntityHandle entity;
+
+		union {
+			struct { float x; float y; bool exploding; } spawn;
+			struct { float x; float y; } explode;
+			struct { float power; float amplitude; } shake;
+		};
+	};
+
+	std::vector<_Command> _commands;
+
+};
+
+#endif
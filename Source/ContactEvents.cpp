@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "ContactEvents.h"
+
+#include <algorithm>
+#include <numeric>
+
+void ContactEvents::Record(Kind kind, const Entity& a, const Entity& b, const b2Vec2& normal, float approachSpeed) {
+	// store the pair with the lower type first, so all events of a pair
+	// have the same types and are dispatched in one run
+	if (b.GetType() < a.GetType()) {
+		Record(kind, b, a, -normal, approachSpeed);
+		return;
+	}
+
+	_kinds.push_back(kind);
+	_a.push_back(a.Handle());
+	_b.push_back(b.Handle());
+	_types_a.push_back(a.GetType());
+	_types_b.push_back(b.GetType());
+	_normals_x.push_back(normal.x);
+	_normals_y.push_back(normal.y);
+	_approach_speeds.push_back(approachSpeed);
+}
+
+void ContactEvents::Clear() {
+	_kinds.clear();
+	_a.clear();
+	_b.clear();
+	_types_a.clear();
+	_types_b.clear();
+	_normals_x.clear();
+	_normals_y.clear();
+	_approach_speeds.clear();
+	_order.clear();
+}
+
+void ContactEvents::Prepare() {
+	uint32_t size = Size();
+
+	// group the events by pair, in the order they happened
+	_order.resize(size);
+	std::iota(_order.begin(), _order.end(), 0);
+	std::stable_sort(_order.begin(), _order.end(), [this](uint32_t i, uint32_t j) {
+		return _PairKey(i) < _PairKey(j);
+	});
+
+	// cancel ends that are followed by a begin
+	_cancelled.assign(size, false);
+	int64_t last = -1;
+
+	for (uint32_t k = 0; k < size; k++) {
+		uint32_t i = _order[k];
+
+		if (last >= 0 && _PairKey(last) != _PairKey(i)) {
+			last = -1;
+		}
+
+		if (last >= 0 && _kinds[last] == END && _kinds[i] == BEGIN) {
+			_cancelled[last] = true;
+			_cancelled[i] = true;
+			last = -1;
+		} else {
+			last = i;
+		}
+	}
+
+	// keep the remaining events, sorted by type and then by time
+	_order.erase(std::remove_if(_order.begin(), _order.end(), [this](uint32_t i) {
+		return _cancelled[i];
+	}), _order.end());
+
+	std::sort(_order.begin(), _order.end(), [this](uint32_t i, uint32_t j) {
+		unsigned ti = _TypeKey(i);
+		unsigned tj = _TypeKey(j);
+		return ti < tj || (ti == tj && i < j);
+	});
+}
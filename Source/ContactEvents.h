@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef CONTACTEVENTS_H_
+#define CONTACTEVENTS_H_
+
+#include <algorithm>
+#include <vector>
+
+#include <Box2D/Box2D.h>
+
+#include "Entity.h"
+
+/**
+ * Records the contacts that begin and end during the physics step, in flat
+ * arrays, so they can be handled in one batch after the step.
+ */
+class ContactEvents {
+
+public:
+	enum Kind : uint8_t {
+		BEGIN,
+		END
+	};
+
+	/**
+	 * The contact, as seen from one of the entities.
+	 */
+	struct Contact {
+		// points from this entity to the other
+		b2Vec2 normal;
+
+		// the speed at which the entities approached each other
+		float approach_speed;
+	};
+
+	/**
+	 * Records an event of the entities in either order, the fixtures of a
+	 * contact that is lost and found again may have swapped. The normal
+	 * points from a to b.
+	 */
+	void Record(Kind kind, const Entity& a, const Entity& b, const b2Vec2& normal, float approachSpeed);
+	void Clear();
+
+	/**
+	 * Cancels every end of a contact that is directly followed by a new
+	 * begin of the same pair, as happens when a contact is lost and found
+	 * again between substeps, and sorts the remaining events by the types
+	 * of the entities involved. Events of the same pair keep their order.
+	 */
+	void Prepare();
+
+	inline size_t Size() const { return _kinds.size(); }
+
+	/*
+	 * After Prepare(), the indices of the remaining events, sorted by type.
+	 */
+	inline const std::vector<uint32_t>& Order() const { return _order; }
+
+	inline Kind GetKind(uint32_t i)           const { return _kinds[i];    }
+	inline const EntityHandle& A(uint32_t i)  const { return _a[i];        }
+	inline const EntityHandle& B(uint32_t i)  const { return _b[i];        }
+	inline Entity::Type TypeA(uint32_t i)     const { return _types_a[i];  }
+	inline Entity::Type TypeB(uint32_t i)     const { return _types_b[i];  }
+
+	/*
+	 * The contact as seen from entity A, or from entity B.
+	 */
+	inline Contact ContactA(uint32_t i) const { return { {  _normals_x[i],  _normals_y[i] }, _approach_speeds[i] }; }
+	inline Contact ContactB(uint32_t i) const { return { { -_normals_x[i], -_normals_y[i] }, _approach_speeds[i] }; }
+
+private:
+	/*
+	 * Tiles share their colliders, whose user data can change when they
+	 * are rebuilt, so all tiles count as the same entity for the pair key.
+	 */
+	inline static uint32_t _Identity(const EntityHandle& handle, Entity::Type type) {
+		return type == Entity::WALL || type == Entity::SHOOTER ? 0 : handle.Value();
+	}
+
+	inline uint64_t _PairKey(uint32_t i) const {
+		uint32_t a = _Identity(_a[i], _types_a[i]);
+		uint32_t b = _Identity(_b[i], _types_b[i]);
+		return (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+	}
+
+	inline unsigned _TypeKey(uint32_t i) const { return _types_a[i] * Entity::TYPE_COUNT + _types_b[i]; }
+
+	std::vector<Kind> _kinds;
+	std::vector<EntityHandle> _a;
+	std::vector<EntityHandle> _b;
+	std::vector<Entity::Type> _types_a;
+	std::vector<Entity::Type> _types_b;
+	std::vector<float> _normals_x;
+	std::vector<float> _normals_y;
+	std::vector<float> _approach_speeds;
+
+	std::vector<uint32_t> _order;
+	std::vector<bool> _cancelled;
+
+};
+
+#endif
@@ -6,25 +6,24 @@
 
 #include <cmath>
 
+LineBatch::Mesh Diamond::_mesh;
+bool Diamond::_is_renderer_prepared = false;
+
 Diamond::Diamond(float x, float y, float vx, float vy) :
-		Entity(x, y, 0.0f),
+		Entity(DIAMOND, x, y, 0.0f),
 		_start_vx(vx), _start_vy(vy) {}
 
-void Diamond::Render(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) const {
-	_PrepareRenderer();
+void Diamond::Respawn(float x, float y, float vx, float vy) {
+	_Respawn(x, y, 0.0f, vx, vy);
+}
 
-	_line_shader.Use();
-	_line_shader["screenDimensions"] = (glm::vec2) screenDimensions;
-	_line_shader["location"] = glm::vec2 { _x + 0.35f, _y - 0.35f };
-	_line_shader["color"] = glm::vec4 { 0.5764f, 0.8431f, 1.0f, 1.0f };
-	_line_shader["rotation"] = (float) (_rotation + M_PI / 4);
-	_line_shader["rotationCenter"] = glm::vec2 { 0.15f, 0.15f };
-	_line_shader["cameraParams"] = cameraParams;
-	_line_shader["scale"] = 1.0f;
+void Diamond::Render(LineBatch& batch) const {
+	_PrepareRenderer();
 
-	glBindVertexArray(_vao);
-	glDrawArrays(GL_LINE_LOOP, 0, _count);
-	glBindVertexArray(0);
+	batch.Add(_mesh, {
+		{ _render_x + 0.35f, _render_y - 0.35f }, (float) (_render_rotation + M_PI / 4), { 0.15f, 0.15f }, 1.0f,
+		{ 0.5764f, 0.8431f, 1.0f, 1.0f }
+	});
 }
 
 
@@ -46,34 +45,18 @@ void Diamond::_CreateFixture(std::shared_ptr<b2Body> body) const {
 	fixture->SetFriction(1.0f);
 }
 
-void Diamond::_PrepareRenderer() const {
-	_PrepareShader();
-
+void Diamond::_PrepareRenderer() {
 	if (_is_renderer_prepared) {
 		return;
 	}
 
-	// prepare the VAO/VBO for rendering
-	std::vector<GLfloat> data {
+	// prepare the mesh for rendering
+	_mesh = LineBatch::CreateMesh(GL_LINE_LOOP, {
 		0.0f, 0.0f,
 		0.0f, 0.4f,
 		0.4f, 0.4f,
 		0.4f, 0.0f
-	};
-
-	_count = data.size() / 2;
-
-	_vao = GL::GenVertexArray();
-	_vbo = GL::GenBuffer();
-
-	glBindVertexArray(_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(GLfloat), data.data(), GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void *) 0);
-
-	glBindVertexArray(0);
+	});
 
 	_is_renderer_prepared = true;
 }
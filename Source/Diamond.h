@@ -12,19 +12,19 @@ class Diamond : public Entity {
 public:
 	Diamond(float x, float y, float vx, float vy);
 
-	void Render(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) const;
+	void Respawn(float x, float y, float vx, float vy);
+
+	void Render(LineBatch& batch) const;
 
 protected:
 	b2BodyDef _CreateBody() const;
 	void _CreateFixture(std::shared_ptr<b2Body> body) const;
 
 private:
-	void _PrepareRenderer() const;
+	static void _PrepareRenderer();
 
-	mutable GLhandle _vao;
-	mutable GLhandle _vbo;
-	mutable unsigned _count = 0;
-	mutable bool _is_renderer_prepared = false;
+	static LineBatch::Mesh _mesh;
+	static bool _is_renderer_prepared;
 
 	float _start_vx;
 	float _start_vy;
@@ -4,11 +4,10 @@
 
 #include "Entity.h"
 
-ShaderProgram Entity::_line_shader;
-bool Entity::_is_shader_prepared(false);
-
-Entity::Entity(float x, float y, float rotation) :
-		_x(x), _y(y), _rotation(rotation) {}
+Entity::Entity(Type type, float x, float y, float rotation) :
+		_type(type), _x(x), _y(y), _rotation(rotation),
+		_previous_x(x), _previous_y(y), _previous_rotation(rotation),
+		_render_x(x), _render_y(y), _render_rotation(rotation) {}
 
 void Entity::Initialize(std::shared_ptr<b2World> world) {
 	// create the body
@@ -16,7 +15,6 @@ void Entity::Initialize(std::shared_ptr<b2World> world) {
 	bodyDef.position.x = _x;
 	bodyDef.position.y = _y;
 	bodyDef.angle = _rotation;
-	bodyDef.userData = this;
 
 	_b2_body = std::shared_ptr<b2Body>(world->CreateBody(&bodyDef), [world](b2Body *body) {
 		world->DestroyBody(body);
@@ -24,21 +22,43 @@ void Entity::Initialize(std::shared_ptr<b2World> world) {
 
 	// create the fixture
 	_CreateFixture(_b2_body);
+
+	b2Filter filter = CollisionFilter(_type);
+
+	for (b2Fixture *fixture = _b2_body->GetFixtureList(); fixture; fixture = fixture->GetNext()) {
+		fixture->SetFilterData(filter);
+		fixture->SetUserData(_handle.ToUserData());
+	}
 }
 
 void Entity::Update(float dt, Level& level) {
-	_x = _b2_body->GetPosition().x;
-	_y = _b2_body->GetPosition().y;
-	_rotation = _b2_body->GetAngle();
-
-	for (auto f : _on_update) {
-		f(*this, level);
+	_previous_x = _x;
+	_previous_y = _y;
+	_previous_rotation = _rotation;
+
+	if (_b2_body) {
+		_x = _b2_body->GetPosition().x;
+		_y = _b2_body->GetPosition().y;
+		_rotation = _b2_body->GetAngle();
 	}
-	_on_update.clear();
 
 	InternalUpdate(dt, level);
 }
 
+void Entity::Interpolate(float alpha) {
+	_render_x = _previous_x + (_x - _previous_x) * alpha;
+	_render_y = _previous_y + (_y - _previous_y) * alpha;
+	_render_rotation = _previous_rotation + (_rotation - _previous_rotation) * alpha;
+}
+
+Entity::Type Entity::GetType() const {
+	return _type;
+}
+
+const EntityHandle& Entity::Handle() const {
+	return _handle;
+}
+
 float& Entity::X() {
 	return _x;
 }
@@ -47,6 +67,10 @@ float& Entity::Y() {
 	return _y;
 }
 
+glm::vec2 Entity::RenderPosition() const {
+	return { _render_x, _render_y };
+}
+
 const b2Body *Entity::Body() {
 	return _b2_body.get();
 }
@@ -59,14 +83,63 @@ bool Entity::IsAlive() {
 	return _alive;
 }
 
-void Entity::_PrepareShader() {
-	if (_is_shader_prepared) {
+void Entity::Deactivate() {
+	// removes the body from the broadphase, but keeps it for a respawn
+	if (_b2_body) {
+		_b2_body->SetActive(false);
+	}
+}
+
+void Entity::SetDormant(bool dormant) {
+	if (_dormant == dormant) {
 		return;
 	}
 
-	_line_shader.AddShaderFromFile(GL_VERTEX_SHADER, "Resources/shader.vert.glsl");
-	_line_shader.AddShaderFromFile(GL_FRAGMENT_SHADER, "Resources/shader.frag.glsl");
-	_line_shader.Link();
+	_dormant = dormant;
+
+	if (_b2_body) {
+		_b2_body->SetActive(!dormant);
+	}
+}
+
+bool Entity::IsDormant() const {
+	return _dormant;
+}
+
+void Entity::ApplyImpulse(const glm::vec2& impulse, const glm::vec2& point) {
+	_b2_body->ApplyLinearImpulse({ impulse.x, impulse.y }, { point.x, point.y }, true);
+}
+
+void Entity::_SetHandle(const EntityHandle& handle) {
+	_handle = handle;
+
+	if (_b2_body) {
+		for (b2Fixture *fixture = _b2_body->GetFixtureList(); fixture; fixture = fixture->GetNext()) {
+			fixture->SetUserData(_handle.ToUserData());
+		}
+	}
+}
+
+void Entity::_Respawn(float x, float y, float rotation, float vx, float vy) {
+	_x = _previous_x = _render_x = x;
+	_y = _previous_y = _render_y = y;
+	_rotation = _previous_rotation = _render_rotation = rotation;
+	_alive = true;
+	_dormant = false;
+
+	if (_b2_body) {
+		_b2_body->SetTransform({ x, y }, rotation);
+		_b2_body->SetLinearVelocity({ vx, vy });
+		_b2_body->SetAngularVelocity(0.0f);
+		_b2_body->SetActive(true);
+		_b2_body->SetAwake(true);
+	}
+}
 
-	_is_shader_prepared = true;
+b2Filter Entity::CollisionFilter(Type type) {
+	// bullets have no bodies, the BulletSystem decides what they hit
+	b2Filter filter;
+	filter.categoryBits = 1 << type;
+	filter.maskBits = (1 << TYPE_COUNT) - 1;
+	return filter;
 }
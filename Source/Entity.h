@@ -5,51 +5,98 @@
 #ifndef ENTITY_H_
 #define ENTITY_H_
 
+#include <cstdint>
+
 #include <Box2D/Box2D.h>
 #include <glm/glm.hpp>
 
-#include "ShaderProgram.h"
+#include "EntityHandle.h"
+#include "LineBatch.h"
 
 class Level;
 
 class Entity {
+	friend class Level;
+
+	template<typename T>
+	friend class EntityStorage;
 
 public:
-	Entity(float x, float y, float rotation);
+	enum Type : uint8_t {
+		WALL,
+		SHOOTER,
+		PLAYER,
+		DIAMOND,
+		TYPE_COUNT
+	};
+
+	Entity(Type type, float x, float y, float rotation);
 	virtual ~Entity() = default;
 
 	void Initialize(std::shared_ptr<b2World> world);
 
 	void Update(float dt, Level& level);
-	virtual void Render(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) const = 0;
+	void Interpolate(float alpha);
+	virtual void Render(LineBatch& batch) const = 0;
 
-	virtual void OnCollisionStart(Entity *other, b2Contact *contact) {}
-	virtual void OnCollisionEnd(Entity *other, b2Contact *contact) {}
+	Type GetType() const;
+	const EntityHandle& Handle() const;
 
 	float& X();
 	float& Y();
+	glm::vec2 RenderPosition() const;
 	const b2Body *Body();
 
 	void Die();
 	bool IsAlive();
+	void Deactivate();
+
+	/*
+	 * Dormant entities are outside the activity region of the level, their
+	 * bodies are removed from the simulation until they wake up again.
+	 */
+	void SetDormant(bool dormant);
+	bool IsDormant() const;
+	void ApplyImpulse(const glm::vec2& impulse, const glm::vec2& point);
+
+	/*
+	 * The category and mask bits of the fixtures of an entity of the given
+	 * type, so pairs that never respond to each other are already dropped
+	 * in the broadphase.
+	 */
+	static b2Filter CollisionFilter(Type type);
 
 protected:
+	const Type _type;
 	float _x;
 	float _y;
 	float _rotation;
 	float _alive = true;
+	bool _dormant = false;
+
+	// the transform at the previous tick, and the one interpolated for rendering
+	float _previous_x;
+	float _previous_y;
+	float _previous_rotation;
+	float _render_x;
+	float _render_y;
+	float _render_rotation;
 
-	std::vector<std::function<void(Entity&, Level&)>> _on_update;
 	std::shared_ptr<b2Body> _b2_body;
 
-	virtual void InternalUpdate(float dt, Level& level) {}
-	virtual b2BodyDef _CreateBody() const = 0;
-	virtual void _CreateFixture(std::shared_ptr<b2Body> body) const = 0;
+	// index in the dense array of the EntityStorage that owns this entity
+	unsigned _storage_index = 0;
+	EntityHandle _handle;
 
-protected:
-	static ShaderProgram _line_shader;
-	static bool _is_shader_prepared;
-	static void _PrepareShader();
+	void _SetHandle(const EntityHandle& handle);
+
+	void _Respawn(float x, float y, float rotation, float vx, float vy);
+
+	virtual void InternalUpdate(float dt, Level& level) {}
+	// entities without a body of their own, like the tiles of the
+	// TileMap, keep these defaults and are never initialized
+	virtual b2BodyDef _CreateBody() const { return b2BodyDef(); }
+	virtual void _CreateFixture(std::shared_ptr<b2Body> body) const {}
 };
 
 #endif
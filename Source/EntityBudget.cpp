@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "EntityBudget.h"
+
+#include <algorithm>
+
+void EntityBudget::SetMaxBullets(size_t maxBullets) {
+	_max_bullets = maxBullets;
+}
+
+void EntityBudget::SetThrottleThreshold(float fraction, float minFireRate) {
+	_throttle_threshold = fraction;
+	_min_fire_rate = minFireRate;
+}
+
+void EntityBudget::SetMergeThreshold(float fraction, float minDistance, float mergeRadius) {
+	_merge_threshold = fraction;
+	_merge_distance = minDistance;
+	_merge_radius = mergeRadius;
+}
+
+size_t EntityBudget::MaxBullets() const {
+	return _max_bullets;
+}
+
+size_t EntityBudget::ThrottleCount() const {
+	return size_t(_max_bullets * _throttle_threshold);
+}
+
+size_t EntityBudget::MergeCount() const {
+	return size_t(_max_bullets * _merge_threshold);
+}
+
+float EntityBudget::MergeDistance() const {
+	return _merge_distance;
+}
+
+float EntityBudget::MergeRadius() const {
+	return _merge_radius;
+}
+
+float EntityBudget::FireRate(size_t bullets) const {
+	size_t throttleCount = ThrottleCount();
+
+	if (bullets <= throttleCount || _max_bullets <= throttleCount) {
+		return 1.0f;
+	}
+
+	float t = std::min(float(bullets - throttleCount) / (_max_bullets - throttleCount), 1.0f);
+	return 1.0f + t * (_min_fire_rate - 1.0f);
+}
+
+EntityBudget::Counters& EntityBudget::GetCounters() {
+	return _counters;
+}
+
+const EntityBudget::Counters& EntityBudget::GetCounters() const {
+	return _counters;
+}
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef ENTITYBUDGET_H_
+#define ENTITYBUDGET_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounds the number of bullets in a level, so the cost of a tick stays
+ * bounded however long a session runs. The level degrades gracefully as
+ * the bullet count approaches the budget:
+ *
+ *  - above the throttle threshold, shooters charge more slowly;
+ *  - above the merge threshold, bullets far from the player that are close
+ *    to each other are merged into one;
+ *  - above the budget, the oldest shooter bullets are recycled.
+ *
+ * The counters record how often each policy kicked in.
+ */
+class EntityBudget {
+
+public:
+	struct Counters {
+		// ticks in which the shooters were slowed down
+		uint64_t throttled_ticks = 0;
+
+		// bullets removed by merging and by recycling
+		uint64_t merged_bullets = 0;
+		uint64_t recycled_bullets = 0;
+	};
+
+	void SetMaxBullets(size_t maxBullets);
+	void SetThrottleThreshold(float fraction, float minFireRate);
+	void SetMergeThreshold(float fraction, float minDistance, float mergeRadius);
+
+	size_t MaxBullets() const;
+	size_t ThrottleCount() const;
+	size_t MergeCount() const;
+	float MergeDistance() const;
+	float MergeRadius() const;
+
+	/**
+	 * The factor by which shooters charge, for the given number of bullets.
+	 * Falls linearly from 1 at the throttle threshold to the minimum fire
+	 * rate at the budget.
+	 */
+	float FireRate(size_t bullets) const;
+
+	Counters& GetCounters();
+	const Counters& GetCounters() const;
+
+private:
+	size_t _max_bullets = 10000;
+
+	float _throttle_threshold = 0.75f;
+	float _min_fire_rate = 0.25f;
+
+	float _merge_threshold = 0.9f;
+	float _merge_distance = 16.0f;
+	float _merge_radius = 0.5f;
+
+	Counters _counters;
+
+};
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef ENTITYHANDLE_H_
+#define ENTITYHANDLE_H_
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * A 32-bit reference to an entity, consisting of a slot index in the
+ * EntityRegistry and the generation of that slot. When the entity is
+ * removed, the generation of the slot changes, so all handles to the old
+ * entity become invalid instead of dangling. The default handle is never
+ * valid.
+ */
+class EntityHandle {
+
+public:
+	static constexpr unsigned index_bits = 22;
+	static constexpr unsigned generation_bits = 32 - index_bits;
+	static constexpr uint32_t index_mask = (1u << index_bits) - 1;
+	static constexpr uint32_t generation_mask = (1u << generation_bits) - 1;
+
+	EntityHandle() : _value(0) {}
+	EntityHandle(uint32_t index, uint32_t generation) :
+			_value((generation << index_bits) | (index & index_mask)) {}
+
+	inline uint32_t Index() const { return _value & index_mask; }
+	inline uint32_t Generation() const { return _value >> index_bits; }
+	inline uint32_t Value() const { return _value; }
+
+	inline explicit operator bool() const { return _value != 0; }
+	inline bool operator==(const EntityHandle& other) const { return _value == other._value; }
+	inline bool operator!=(const EntityHandle& other) const { return _value != other._value; }
+	inline bool operator<(const EntityHandle& other) const { return _value < other._value; }
+
+	/*
+	 * Conversion to and from the user data of Box2D bodies.
+	 */
+	inline void *ToUserData() const { return reinterpret_cast<void *>(uintptr_t(_value)); }
+	inline static EntityHandle FromUserData(void *userData) { return EntityHandle(uint32_t(uintptr_t(userData))); }
+
+private:
+	explicit EntityHandle(uint32_t value) : _value(value) {}
+
+	uint32_t _value;
+
+};
+
+namespace std {
+
+template<>
+struct hash<EntityHandle> {
+	size_t operator()(const EntityHandle& handle) const {
+		return handle.Value();
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "EntityRegistry.h"
+
+EntityHandle EntityRegistry::Create(Entity *entity) {
+	uint32_t index;
+
+	if (_free_slots.empty()) {
+		// generation 0 is skipped, so a default handle is never valid
+		index = _slots.size();
+		_slots.push_back({ nullptr, 1 });
+	} else {
+		index = _free_slots.front();
+		_free_slots.pop_front();
+	}
+
+	_slots[index].entity = entity;
+	return EntityHandle(index, _slots[index].generation);
+}
+
+void EntityRegistry::Destroy(const EntityHandle& handle) {
+	if (!Get(handle)) {
+		return;
+	}
+
+	_Slot& slot = _slots[handle.Index()];
+	slot.entity = nullptr;
+
+	// the next generation would wrap around to handles that may still
+	// exist, so the slot is retired, with a generation no handle has
+	if (slot.generation == EntityHandle::generation_mask) {
+		slot.generation = 0;
+		return;
+	}
+
+	// invalidate all existing handles to the slot
+	slot.generation++;
+	_free_slots.push_back(handle.Index());
+}
@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef ENTITYREGISTRY_H_
+#define ENTITYREGISTRY_H_
+
+#include <deque>
+#include <vector>
+
+#include "EntityHandle.h"
+
+class Entity;
+
+/**
+ * Maps entity handles to entities in constant time. Freed slots are reused
+ * in the order they were freed, and a slot that ran out of generations is
+ * never reused, so an old handle can't become valid again.
+ */
+class EntityRegistry {
+
+public:
+	EntityHandle Create(Entity *entity);
+
+	/**
+	 * Invalidates the handle, does nothing if it is no longer valid.
+	 */
+	void Destroy(const EntityHandle& handle);
+
+	/**
+	 * Returns the entity, or nullptr if the handle is no longer valid.
+	 */
+	inline Entity *Get(const EntityHandle& handle) const {
+		if (handle.Index() >= _slots.size()) {
+			return nullptr;
+		}
+
+		const _Slot& slot = _slots[handle.Index()];
+		return slot.generation == handle.Generation() ? slot.entity : nullptr;
+	}
+
+private:
+	struct _Slot {
+		Entity *entity;
+		uint32_t generation;
+	};
+
+	std::vector<_Slot> _slots;
+	std::deque<uint32_t> _free_slots;
+
+};
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef ENTITYSTORAGE_H_
+#define ENTITYSTORAGE_H_
+
+#include <deque>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Entity.h"
+#include "EntityRegistry.h"
+
+/**
+ * Owns all entities of a single type. The entities themselves live in
+ * chunks that never move, while the living ones are kept in a dense array
+ * for iteration. Living entities are registered in the EntityRegistry, so
+ * each respawn gets a new handle. Removed entities keep their
+ * (deactivated) Box2D body and are recycled by Acquire().
+ */
+template<typename T>
+class EntityStorage {
+	static_assert(std::is_base_of<Entity, T>::value, "Entity instance must derive from Entity");
+
+public:
+	EntityStorage(EntityRegistry& registry) : _registry(registry) {}
+
+	EntityStorage(const EntityStorage&) = delete;
+	EntityStorage& operator=(const EntityStorage&) = delete;
+
+	/**
+	 * Constructs a new living entity. It still has to be initialized.
+	 */
+	template<typename ... Args>
+	T *Create(Args&& ... args) {
+		_storage.emplace_back(std::forward<Args>(args) ...);
+		T *entity = &_storage.back();
+		_Insert(entity);
+		return entity;
+	}
+
+	/**
+	 * Returns a removed entity to respawn, or nullptr if there is none.
+	 */
+	T *Acquire() {
+		if (_free.empty()) {
+			return nullptr;
+		}
+
+		T *entity = _free.back();
+		_free.pop_back();
+		_Insert(entity);
+		return entity;
+	}
+
+	/**
+	 * Removes a living entity by swapping it with the last one, and keeps
+	 * it for later use.
+	 */
+	void Remove(T *entity) {
+		unsigned index = entity->_storage_index;
+
+		_alive[index] = _alive.back();
+		_alive[index]->_storage_index = index;
+		_alive.pop_back();
+
+		// deactivating ends the contacts of the body, but their events are
+		// dispatched after the handle is destroyed, so they are dropped.
+		// Whoever keeps the handle must notice it became invalid, like the
+		// player forgets the walls it was touching.
+		entity->Deactivate();
+		_registry.Destroy(entity->_handle);
+		_free.push_back(entity);
+	}
+
+	/**
+	 * Removes all dead entities.
+	 */
+	void RemoveDead() {
+		for (size_t i = 0; i < _alive.size();) {
+			if (_alive[i]->IsAlive()) {
+				i++;
+			} else {
+				Remove(_alive[i]);
+			}
+		}
+	}
+
+	inline size_t Size() const { return _alive.size(); }
+	inline T *operator[](size_t index) const { return _alive[index]; }
+
+	inline typename std::vector<T *>::const_iterator begin() const { return _alive.begin(); }
+	inline typename std::vector<T *>::const_iterator end()   const { return _alive.end();   }
+
+private:
+	void _Insert(T *entity) {
+		entity->_storage_index = _alive.size();
+		entity->_SetHandle(_registry.Create(entity));
+		_alive.push_back(entity);
+	}
+
+	EntityRegistry& _registry;
+	std::deque<T> _storage;
+	std::vector<T *> _alive;
+	std::vector<T *> _free;
+
+};
+
+#endif
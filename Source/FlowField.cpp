@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "FlowField.h"
+
+#include <cmath>
+
+bool FlowField::Update(const TileMap& tiles, int targetX, int targetY) {
+	if (targetX == _target_x && targetY == _target_y && tiles.Version() == _tiles_version) {
+		return false;
+	}
+
+	_target_x = targetX;
+	_target_y = targetY;
+	_tiles_version = tiles.Version();
+
+	_Search(tiles);
+	return true;
+}
+
+bool FlowField::Sample(float x, float y, glm::vec2& direction, float& distance) const {
+	int i = int(std::round(x));
+	int j = int(std::round(y));
+
+	if (i < 0 || j < 0 || unsigned(i) >= _width || unsigned(j) >= _height) {
+		return false;
+	}
+
+	unsigned index = j * _width + i;
+
+	if (_distances[index] == unreachable) {
+		return false;
+	}
+
+	direction = { _directions_x[index], _directions_y[index] };
+	distance = _distances[index];
+	return true;
+}
+
+void FlowField::_Search(const TileMap& tiles) {
+	_width = tiles.Width();
+	_height = tiles.Height();
+	_distances.assign(_width * _height, unreachable);
+	_directions_x.assign(_width * _height, 0.0f);
+	_directions_y.assign(_width * _height, 0.0f);
+	_queue.clear();
+
+	if (_target_x < 0 || _target_y < 0 || unsigned(_target_x) >= _width || unsigned(_target_y) >= _height
+			|| tiles.IsSolid(_target_x, _target_y)) {
+		return;
+	}
+
+	// breadth-first over the free tiles, in four directions
+	static const int steps[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+	_distances[_target_y * _width + _target_x] = 0;
+	_queue.push_back(_target_y * _width + _target_x);
+
+	for (size_t head = 0; head < _queue.size(); head++) {
+		int x = _queue[head] % _width;
+		int y = _queue[head] / _width;
+		uint16_t distance = _distances[_queue[head]] + 1;
+
+		for (const auto& step : steps) {
+			int nx = x + step[0];
+			int ny = y + step[1];
+
+			if (nx < 0 || ny < 0 || unsigned(nx) >= _width || unsigned(ny) >= _height || tiles.IsSolid(nx, ny)) {
+				continue;
+			}
+
+			uint32_t index = ny * _width + nx;
+
+			if (_distances[index] == unreachable) {
+				_distances[index] = distance;
+				_queue.push_back(index);
+			}
+		}
+	}
+
+	// point every tile at its closest neighbour, diagonals included as
+	// long as they don't cut a corner
+	for (uint32_t index : _queue) {
+		int x = index % _width;
+		int y = index / _width;
+		uint16_t best = _distances[index];
+		int bestX = 0;
+		int bestY = 0;
+
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				int nx = x + dx;
+				int ny = y + dy;
+
+				if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || unsigned(nx) >= _width || unsigned(ny) >= _height) {
+					continue;
+				}
+
+				if (dx != 0 && dy != 0 && (tiles.IsSolid(nx, y) || tiles.IsSolid(x, ny))) {
+					continue;
+				}
+
+				if (_distances[ny * _width + nx] < best) {
+					best = _distances[ny * _width + nx];
+					bestX = dx;
+					bestY = dy;
+				}
+			}
+		}
+
+		float length = std::sqrt(float(bestX * bestX + bestY * bestY));
+
+		if (length > 0.0f) {
+			_directions_x[index] = bestX / length;
+			_directions_y[index] = bestY / length;
+		}
+	}
+}
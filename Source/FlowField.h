@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef FLOWFIELD_H_
+#define FLOWFIELD_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TileMap.h"
+
+/**
+ * The shortest paths from every free tile to a target tile, found with a
+ * breadth-first search over the tile grid. Each tile stores its distance
+ * in steps and the direction to the neighbour that is closest to the
+ * target, so following the field leads around walls.
+ */
+class FlowField {
+
+public:
+	static constexpr uint16_t unreachable = 0xFFFF;
+
+	/**
+	 * Searches again from the target tile, but only if the target moved to
+	 * another tile or the tile map changed. Returns whether it did.
+	 */
+	bool Update(const TileMap& tiles, int targetX, int targetY);
+
+	/**
+	 * Looks up the tile at the position. Returns false if it is outside
+	 * the grid, solid or can't reach the target.
+	 */
+	bool Sample(float x, float y, glm::vec2& direction, float& distance) const;
+
+private:
+	void _Search(const TileMap& tiles);
+
+	unsigned _width = 0;
+	unsigned _height = 0;
+	int _target_x = -1;
+	int _target_y = -1;
+	uint64_t _tiles_version = ~uint64_t(0);
+
+	std::vector<uint16_t> _distances;
+	std::vector<float> _directions_x;
+	std::vector<float> _directions_y;
+	std::vector<uint32_t> _queue;
+
+};
+
+#endif
@@ -0,0 +1,24 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "FrameUniforms.h"
+
+#include "UniformBuffer.h"
+
+static_assert(sizeof(FrameUniforms) == 32, "FrameUniforms must match the std140 layout of the Frame block");
+
+constexpr GLuint FrameUniforms::binding;
+
+void FrameUniforms::Upload(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) {
+	static UniformBuffer<FrameUniforms> buffer(binding);
+
+	FrameUniforms frame {};
+	frame.screen_dimensions = screenDimensions;
+	frame.camera_params = cameraParams;
+	buffer.Upload(frame);
+}
+
+void FrameUniforms::AddTo(ShaderProgram& program) {
+	program.AddUniformBlock("Frame", binding);
+}
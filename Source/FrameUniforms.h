@@ -0,0 +1,38 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef FRAMEUNIFORMS_H_
+#define FRAMEUNIFORMS_H_
+
+#include <glm/glm.hpp>
+
+#include "GL.h"
+#include "ShaderProgram.h"
+
+/**
+ * The uniforms shared by every program that draws the level, uploaded once
+ * per frame. Matches the std140 layout of the block
+ *
+ *     layout(std140) uniform Frame {
+ *         vec2 screenDimensions;
+ *         vec3 cameraParams;
+ *     };
+ */
+struct FrameUniforms {
+	glm::vec2 screen_dimensions;
+	GLfloat _padding0[2];
+	glm::vec3 camera_params;
+	GLfloat _padding1;
+
+	static constexpr GLuint binding = 0;
+
+	static void Upload(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams);
+
+	/**
+	 * Binds the Frame block of the program, call before linking.
+	 */
+	static void AddTo(ShaderProgram& program);
+};
+
+#endif
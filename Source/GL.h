@@ -6,6 +6,7 @@
 #define GL_H_
 
 #include <GL/glew.h>
+#include "GLState.h"
 #include <memory>
 #include <functional>
 #include <cassert>
@@ -70,22 +71,18 @@ private:
 	GL operator=(const GL&) = delete;
 
 public:
-	inline static GLhandle GenBuffer()       { return GLhandle(glGenBuffers,       glDeleteBuffers      , false); }
-	inline static GLhandle GenFramebuffer()  { return GLhandle(glGenFramebuffers,  glDeleteFramebuffers , false); }
-	inline static GLhandle GenRenderbuffer() { return GLhandle(glGenRenderbuffers, glDeleteRenderbuffers, false); }
-	inline static GLhandle GenTexture()      { return GLhandle(glGenTextures,      glDeleteTextures     , false); }
-	inline static GLhandle GenVertexArray()  { return GLhandle(glGenVertexArrays,  glDeleteVertexArrays , false); }
+	inline static GLhandle GenBuffer()       { return GLhandle(glGenBuffers,       glDeleteBuffers            , false); }
+	inline static GLhandle GenFramebuffer()  { return GLhandle(glGenFramebuffers,  glDeleteFramebuffers       , false); }
+	inline static GLhandle GenRenderbuffer() { return GLhandle(glGenRenderbuffers, glDeleteRenderbuffers      , false); }
+	inline static GLhandle GenTexture()      { return GLhandle(glGenTextures,      GLState::DeleteTextures    , false); }
+	inline static GLhandle GenVertexArray()  { return GLhandle(glGenVertexArrays,  GLState::DeleteVertexArrays, false); }
 
 	inline static GLhandle CreateProgram() {
 		return GLhandle([](GLsizei count, GLuint *ids) {
 			for (GLsizei i = 0; i < count; i++) {
 				ids[i] = glCreateProgram();
 			}
-		}, [](GLsizei count, GLuint *ids) {
-			for (GLsizei i = 0; i < count; i++) {
-				glDeleteProgram(ids[i]);
-			}
-		}, false);
+		}, GLState::DeletePrograms, false);
 	}
 
 private:
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "GLState.h"
+
+// the initial state of an OpenGL context
+GLuint GLState::_program = 0;
+GLuint GLState::_vao = 0;
+GLuint GLState::_active_unit = 0;
+GLuint GLState::_textures[texture_units] = {};
+bool GLState::_blend = false;
+GLenum GLState::_blend_source = GL_ONE;
+GLenum GLState::_blend_destination = GL_ZERO;
+GLState::Counters GLState::_counters;
+
+constexpr GLuint GLState::texture_units;
+
+bool GLState::UniformChanged(std::vector<uint8_t>& shadow, const void *value, size_t size) {
+	if (shadow.size() == size && std::memcmp(shadow.data(), value, size) == 0) {
+		_counters.skipped++;
+		return false;
+	}
+
+	const uint8_t *bytes = static_cast<const uint8_t *>(value);
+	shadow.assign(bytes, bytes + size);
+	_counters.issued++;
+	return true;
+}
+
+void GLState::DeleteVertexArrays(GLsizei count, GLuint *ids) {
+	for (GLsizei i = 0; i < count; i++) {
+		if (_vao == ids[i]) {
+			_vao = 0;
+		}
+	}
+
+	glDeleteVertexArrays(count, ids);
+}
+
+void GLState::DeleteTextures(GLsizei count, GLuint *ids) {
+	for (GLsizei i = 0; i < count; i++) {
+		for (GLuint& texture : _textures) {
+			if (texture == ids[i]) {
+				texture = 0;
+			}
+		}
+	}
+
+	glDeleteTextures(count, ids);
+}
+
+void GLState::DeletePrograms(GLsizei count, GLuint *ids) {
+	for (GLsizei i = 0; i < count; i++) {
+		if (_program == ids[i]) {
+			_program = 0;
+		}
+
+		glDeleteProgram(ids[i]);
+	}
+}
+
+const GLState::Counters& GLState::GetCounters() {
+	return _counters;
+}
+
+void GLState::ResetCounters() {
+	_counters = Counters();
+}
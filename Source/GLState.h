@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef GLSTATE_H_
+#define GLSTATE_H_
+
+#include <GL/glew.h>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Shadows the OpenGL state the renderers change: the program in use, the
+ * bound vertex array, the textures bound to each unit, blending and the
+ * values of the uniforms of each program. Calls that wouldn't change the
+ * state are skipped, so all rendering code should change this state
+ * through here, and never directly.
+ */
+class GLState {
+
+	GLState() = delete;
+
+public:
+	struct Counters {
+		uint64_t issued = 0;
+		uint64_t skipped = 0;
+	};
+
+	inline static void UseProgram(GLuint program) {
+		if (_Changed(_program, program)) {
+			glUseProgram(program);
+		}
+	}
+
+	inline static void BindVertexArray(GLuint vao) {
+		if (_Changed(_vao, vao)) {
+			glBindVertexArray(vao);
+		}
+	}
+
+	/*
+	 * Binds a 2D texture to a texture unit, starting at 0.
+	 */
+	inline static void BindTexture(GLuint unit, GLuint texture) {
+		assert(unit < texture_units);
+
+		if (_textures[unit] == texture) {
+			_counters.skipped++;
+			return;
+		}
+
+		if (_Changed(_active_unit, unit)) {
+			glActiveTexture(GL_TEXTURE0 + unit);
+		}
+
+		_textures[unit] = texture;
+		_counters.issued++;
+		glBindTexture(GL_TEXTURE_2D, texture);
+	}
+
+	inline static void SetBlend(bool enabled) {
+		if (_Changed(_blend, enabled)) {
+			enabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+		}
+	}
+
+	inline static void BlendFunc(GLenum source, GLenum destination) {
+		if (_blend_source == source && _blend_destination == destination) {
+			_counters.skipped++;
+			return;
+		}
+
+		_blend_source = source;
+		_blend_destination = destination;
+		_counters.issued++;
+		glBlendFunc(source, destination);
+	}
+
+	/**
+	 * Whether the value of a uniform differs from its shadowed value, in
+	 * which case the shadow is updated and the caller should upload the
+	 * value. See Uniform.
+	 */
+	static bool UniformChanged(std::vector<uint8_t>& shadow, const void *value, size_t size);
+
+	/*
+	 * Delete objects, forgetting them when they are bound, since their ids
+	 * may be reused by new objects. Used by the handles of GL.
+	 */
+	static void DeleteVertexArrays(GLsizei count, GLuint *ids);
+	static void DeleteTextures(GLsizei count, GLuint *ids);
+	static void DeletePrograms(GLsizei count, GLuint *ids);
+
+	// the minimum number of texture units OpenGL 3.3 supports
+	static constexpr GLuint texture_units = 16;
+
+	static const Counters& GetCounters();
+	static void ResetCounters();
+
+private:
+	template<typename T>
+	inline static bool _Changed(T& current, const T& value) {
+		if (current == value) {
+			_counters.skipped++;
+			return false;
+		}
+
+		current = value;
+		_counters.issued++;
+		return true;
+	}
+
+	static GLuint _program;
+	static GLuint _vao;
+	static GLuint _active_unit;
+	static GLuint _textures[texture_units];
+	static bool _blend;
+	static GLenum _blend_source;
+	static GLenum _blend_destination;
+
+	static Counters _counters;
+
+};
+
+#endif
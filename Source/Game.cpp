@@ -7,10 +7,15 @@
 #include <GLFW/glfw3.h>
 
 #include <chrono>
+#include <iostream>
+#include <string>
 
-Game::Game() :
+#include "GLState.h"
+
+Game::Game(bool diagnostics) :
 		_window(this),
-		_renderer([this](float dt) { RenderGame(dt); }) {
+		_renderer([this](float dt) { RenderGame(dt); }),
+		_diagnostics(diagnostics) {
 
 	_window.Show(_renderer);
 }
@@ -24,16 +29,22 @@ void Game::RenderGame(float dt) {
 
 	switch (_state) {
 		case MAIN_MENU:
-			_main_menu->Render({ _window.Width(), _window.Height() });
+			_main_menu->Render({ _window.Width(), _window.Height() }, _render_queue);
 			break;
 		case CREATING_LEVEL:
 			break;
 		case PLAYING:
 		case GAME_OVER:
-			_current_level.Render(dt, { _window.Width(), _window.Height() });
-			_overlay->Render({ _window.Width(), _window.Height() });
+			_current_level->Render(dt, { _window.Width(), _window.Height() }, _render_queue);
+			_overlay->Render({ _window.Width(), _window.Height() }, _render_queue);
 			break;
 	}
+
+	_render_queue.Execute();
+
+	if (_diagnostics) {
+		_PrintDiagnostics(dt);
+	}
 }
 
 void Game::UpdateGame(float dt) {
@@ -41,11 +52,11 @@ void Game::UpdateGame(float dt) {
 		case CREATING_LEVEL:
 			_current_level = Level::GenerateLevel();
 			_sound_manager.PlayBackground();
-			_overlay = std::make_shared<Overlay>(_current_level);
+			_overlay = std::make_shared<Overlay>(*_current_level);
 			_state = PLAYING;
 			break;
 		case PLAYING:
-			if (!_current_level.Update(dt)) {
+			if (!_current_level->Update(dt)) {
 				_state = GAME_OVER;
 				_sound_manager.StopBackground();
 			}
@@ -60,7 +71,7 @@ void Game::UpdateGame(float dt) {
 void Game::OnMouseMove(float x, float y) {
 	switch (_state) {
 		case PLAYING:
-			_current_level.OnMouseMove(x, y);
+			_current_level->OnMouseMove(x, y);
 			break;
 		default:
 			break;
@@ -70,7 +81,7 @@ void Game::OnMouseMove(float x, float y) {
 void Game::OnMouseButton(int button, int action, int mods) {
 	switch (_state) {
 		case PLAYING:
-			_current_level.OnMouseButton(button, action, mods);
+			_current_level->OnMouseButton(button, action, mods);
 			break;
 		default:
 			break;
@@ -80,7 +91,7 @@ void Game::OnMouseButton(int button, int action, int mods) {
 void Game::OnKey(int key, int scancode, int action, int mods) {
 	switch (_state) {
 		case PLAYING:
-			_current_level.OnKey(key, scancode, action, mods);
+			_current_level->OnKey(key, scancode, action, mods);
 			break;
 		case MAIN_MENU:
 			if (key == GLFW_KEY_ENTER || key == GLFW_KEY_KP_ENTER) {
@@ -97,6 +108,27 @@ void Game::OnKey(int key, int scancode, int action, int mods) {
 	}
 }
 
-int main() {
-	Game game;
+void Game::_PrintDiagnostics(float dt) {
+	_diagnostics_time += dt;
+
+	if (_diagnostics_time < 1.0f) {
+		return;
+	}
+
+	const GLState::Counters& counters = GLState::GetCounters();
+	std::cout << "GL state changes in the last second: " << counters.issued << " issued, "
+			<< counters.skipped << " skipped" << std::endl;
+
+	const RenderQueue::Stats& stats = _render_queue.LastStats();
+	std::cout << "  last frame: " << stats.commands << " draw commands, sorted in "
+			<< stats.sort_time * 1000.0f << "ms, executed in "
+			<< stats.execute_time * 1000.0f << "ms" << std::endl;
+
+	GLState::ResetCounters();
+	_diagnostics_time = 0.0f;
+}
+
+// usage: LD44 [--diagnostics]
+int main(int argc, char **argv) {
+	Game game(argc > 1 && std::string(argv[1]) == "--diagnostics");
 }
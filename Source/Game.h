@@ -5,6 +5,7 @@
 #ifndef GAME_H_
 #define GAME_H_
 
+#include "RenderQueue.h"
 #include "SoundManager.h"
 #include "Overlay.h"
 #include "MainMenu.h"
@@ -20,7 +21,11 @@ public:
 		GAME_OVER
 	};
 
-	Game();
+	/**
+	 * With diagnostics, statistics about the rendering are printed once
+	 * per second.
+	 */
+	Game(bool diagnostics = false);
 
 	void RenderGame(float dt);
 	void UpdateGame(float dt);
@@ -30,15 +35,21 @@ public:
 	void OnKey(int key, int scancode, int action, int mods);
 
 private:
+	void _PrintDiagnostics(float dt);
+
 	Window _window;
 	Renderer _renderer;
+	RenderQueue _render_queue;
 	SoundManager _sound_manager;
 
 	State _state = MAIN_MENU;
-	Level _current_level;
+	std::shared_ptr<Level> _current_level;
 	std::shared_ptr<Overlay> _overlay;
 	std::shared_ptr<MainMenu> _main_menu;
 
+	bool _diagnostics;
+	float _diagnostics_time = 0.0f;
+
 };
 
 #endif
@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "Headless.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include "Resources.h"
+
+const glm::ivec2 Headless::screen_dimensions { 1440, 810 };
+
+Headless::Headless(float dt) :
+		_dt(dt) {}
+
+void Headless::AddKeyEvent(float time, int key, int action) {
+	_AddEvent({ time, KEY, key, action, 0.0f, 0.0f });
+}
+
+void Headless::AddMouseMove(float time, float x, float y) {
+	_AddEvent({ time, MOUSE_MOVE, 0, 0, x, y });
+}
+
+void Headless::AddMouseButton(float time, int button, int action) {
+	_AddEvent({ time, MOUSE_BUTTON, button, action, 0.0f, 0.0f });
+}
+
+static int parseKey(const std::string& name) {
+	if (name == "W")     { return GLFW_KEY_W;     }
+	if (name == "A")     { return GLFW_KEY_A;     }
+	if (name == "D")     { return GLFW_KEY_D;     }
+	if (name == "UP")    { return GLFW_KEY_UP;    }
+	if (name == "LEFT")  { return GLFW_KEY_LEFT;  }
+	if (name == "RIGHT") { return GLFW_KEY_RIGHT; }
+	if (name == "SPACE") { return GLFW_KEY_SPACE; }
+
+	return std::stoi(name);
+}
+
+void Headless::LoadScript(std::istream& input) {
+	std::string line;
+
+	while (std::getline(input, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		std::istringstream stream(line);
+		float time;
+		std::string command;
+
+		if (!(stream >> time >> command)) {
+			std::cerr << "Invalid script line: " << line << std::endl;
+			continue;
+		}
+
+		if (command == "key") {
+			std::string key, action;
+			stream >> key >> action;
+			AddKeyEvent(time, parseKey(key), action == "press" ? GLFW_PRESS : GLFW_RELEASE);
+		} else if (command == "mouse") {
+			float x, y;
+			stream >> x >> y;
+			AddMouseMove(time, x, y);
+		} else if (command == "click") {
+			AddMouseButton(time, GLFW_MOUSE_BUTTON_LEFT, GLFW_PRESS);
+			AddMouseButton(time, GLFW_MOUSE_BUTTON_LEFT, GLFW_RELEASE);
+		} else {
+			std::cerr << "Invalid script command: " << command << std::endl;
+		}
+	}
+}
+
+Headless::Result Headless::Run(const Image& levelImage, float duration) const {
+	auto start = std::chrono::steady_clock::now();
+
+	std::shared_ptr<Level> level = Level::GenerateLevel(levelImage);
+	level->SetTickRate(1.0f / _dt);
+	Result result { 0, 0.0f, 0.0, 0, false, {} };
+
+	auto event = _events.begin();
+
+	while (result.simulated_time < duration) {
+		// the view determines how the mouse coordinates map to the level
+		level->UpdateView(screen_dimensions);
+
+		// feed all the events that are due
+		for (; event != _events.end() && event->time <= result.simulated_time; event++) {
+			switch (event->type) {
+				case KEY:
+					level->OnKey(event->a, 0, event->b, 0);
+					break;
+				case MOUSE_MOVE:
+					level->OnMouseMove(event->x, event->y);
+					break;
+				case MOUSE_BUTTON:
+					level->OnMouseButton(event->a, event->b, 0);
+					break;
+			}
+		}
+
+		result.ticks++;
+		result.simulated_time += _dt;
+
+		if (!level->Update(_dt)) {
+			result.game_over = true;
+			break;
+		}
+	}
+
+	auto end = std::chrono::steady_clock::now();
+
+	result.wall_time = std::chrono::duration<double>(end - start).count();
+	result.score = level->GetPlayer().Score();
+	result.budget = level->GetBudget().GetCounters();
+	return result;
+}
+
+void Headless::_AddEvent(const InputEvent& event) {
+	// keep the events sorted by time, events with equal times keep their order
+	auto it = std::upper_bound(_events.begin(), _events.end(), event, [](const InputEvent& a, const InputEvent& b) {
+		return a.time < b.time;
+	});
+
+	_events.insert(it, event);
+}
+
+// usage: LD44 [duration] [sessions] [script] [level]
+int main(int argc, char **argv) {
+	float duration = argc > 1 ? std::stof(argv[1]) : 60.0f;
+	unsigned sessions = argc > 2 ? std::stoul(argv[2]) : 1;
+
+	Headless headless;
+
+	if (argc > 3) {
+		std::ifstream script(argv[3]);
+		if (!script) {
+			std::cerr << "Couldn't read " << argv[3] << std::endl;
+			return 1;
+		}
+
+		headless.LoadScript(script);
+	}
+
+	const Image& levelImage = argc > 4 ? Image(argv[4]) : Resources::level;
+
+	unsigned totalTicks = 0;
+	double totalTime = 0.0;
+
+	for (unsigned i = 0; i < sessions; i++) {
+		Headless::Result result = headless.Run(levelImage, duration);
+
+		std::cout << "session " << i << ": "
+				<< result.ticks << " ticks, "
+				<< result.simulated_time << "s simulated in "
+				<< result.wall_time << "s, score " << result.score
+				<< (result.game_over ? ", game over" : "") << std::endl;
+
+		std::cout << "  budget: " << result.budget.throttled_ticks << " throttled ticks, "
+				<< result.budget.merged_bullets << " bullets merged, "
+				<< result.budget.recycled_bullets << " bullets recycled" << std::endl;
+
+		totalTicks += result.ticks;
+		totalTime += result.wall_time;
+	}
+
+	std::cout << "total: " << totalTicks << " ticks in " << totalTime << "s ("
+			<< (totalTicks / totalTime) << " ticks/s)" << std::endl;
+}
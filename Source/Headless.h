@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef HEADLESS_H_
+#define HEADLESS_H_
+
+#include <iostream>
+#include <vector>
+
+#include "Level.h"
+
+/**
+ * Runs a level without a window, an OpenGL context or sound. The
+ * simulation is stepped as fast as possible, and input is taken from a
+ * script instead of from GLFW.
+ */
+class Headless {
+
+public:
+	struct Result {
+		unsigned ticks;
+		float simulated_time;
+		double wall_time;
+		unsigned score;
+		bool game_over;
+		EntityBudget::Counters budget;
+	};
+
+	Headless(float dt = 1.0f / 60.0f);
+
+	void AddKeyEvent(float time, int key, int action);
+	void AddMouseMove(float time, float x, float y);
+	void AddMouseButton(float time, int button, int action);
+
+	/**
+	 * Reads an input script. Each line holds a time in seconds followed
+	 * by one of:
+	 *   key <key> <press|release>
+	 *   mouse <x> <y>
+	 *   click
+	 * where <key> is either a GLFW key code, or one of W, A, D, UP, LEFT,
+	 * RIGHT or SPACE. Lines starting with # are ignored.
+	 */
+	void LoadScript(std::istream& input);
+
+	Result Run(const Image& levelImage, float duration) const;
+
+private:
+	enum EventType {
+		KEY, MOUSE_MOVE, MOUSE_BUTTON
+	};
+
+	struct InputEvent {
+		float time;
+		EventType type;
+		int a;
+		int b;
+		float x;
+		float y;
+	};
+
+	void _AddEvent(const InputEvent& event);
+
+	float _dt;
+	std::vector<InputEvent> _events;
+
+public:
+	// the virtual screen the scripted mouse coordinates refer to
+	static const glm::ivec2 screen_dimensions;
+
+};
+
+#endif
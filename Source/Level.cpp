@@ -5,64 +5,145 @@
 #include "Level.h"
 
 #include <algorithm>
+#include <cmath>
 
-#include "Bullet.h"
+#include "CollisionMatrix.h"
 #include "Diamond.h"
+#include "FrameUniforms.h"
 #include "Resources.h"
 
 class CollisionCallback : public b2ContactListener {
+
+public:
+	CollisionCallback(const EntityRegistry& registry, ContactEvents& events) :
+			_registry(registry), _events(events) {}
+
 	void BeginContact(b2Contact *contact) {
-		Entity *e1 = static_cast<Entity *>(contact->GetFixtureA()->GetBody()->GetUserData());
-		Entity *e2 = static_cast<Entity *>(contact->GetFixtureB()->GetBody()->GetUserData());
+		Entity *e1 = _GetEntity(contact->GetFixtureA());
+		Entity *e2 = _GetEntity(contact->GetFixtureB());
+
+		if (e1 && e2) {
+			b2WorldManifold manifold;
+			contact->GetWorldManifold(&manifold);
+
+			b2Vec2 relativeVelocity = contact->GetFixtureB()->GetBody()->GetLinearVelocity()
+					- contact->GetFixtureA()->GetBody()->GetLinearVelocity();
 
-		e1->OnCollisionStart(e2, contact);
-		e2->OnCollisionStart(e1, contact);
+			_events.Record(ContactEvents::BEGIN, *e1, *e2, manifold.normal, -b2Dot(relativeVelocity, manifold.normal));
+		}
 	}
 
 	void EndContact(b2Contact *contact) {
-		Entity *e1 = static_cast<Entity *>(contact->GetFixtureA()->GetBody()->GetUserData());
-		Entity *e2 = static_cast<Entity *>(contact->GetFixtureB()->GetBody()->GetUserData());
+		Entity *e1 = _GetEntity(contact->GetFixtureA());
+		Entity *e2 = _GetEntity(contact->GetFixtureB());
+
+		if (e1 && e2) {
+			_events.Record(ContactEvents::END, *e1, *e2, b2Vec2(0.0f, 0.0f), 0.0f);
+		}
+	}
 
-		e2->OnCollisionEnd(e1, contact);
-		e1->OnCollisionEnd(e2, contact);
+private:
+	Entity *_GetEntity(b2Fixture *fixture) const {
+		// tile colliders resolve to a tile of their region
+		return _registry.Get(EntityHandle::FromUserData(fixture->GetUserData()));
 	}
+
+	const EntityRegistry& _registry;
+	ContactEvents& _events;
+
 };
 
+static const CollisionMatrix collision_matrix;
+
 Level::Level() :
+		_walls(_registry),
+		_shooters(_registry),
+		_block_bullets(glm::vec4 { 1.0f, 0.0f, 0.0f, 1.0f }, true),
+		_player_bullets(glm::vec4 { 1.0f, 1.0f, 0.0f, 1.0f }, false),
+		_diamonds(_registry),
 		_camera_x(12.0f), _camera_y(12.0f) {
 
 	_b2_world = std::shared_ptr<b2World>(new b2World(b2Vec2(0.0f, 20.0f)), [](b2World *w) {
 		delete w;
 	});
 
-	_b2_contact_listener = std::make_shared<CollisionCallback>();
+	_b2_contact_listener = std::make_shared<CollisionCallback>(_registry, _contact_events);
 	_b2_world->SetContactListener(_b2_contact_listener.get());
+
+	_Schedule(5.0f, SPAWN_DIAMOND);
+}
+
+Level::~Level() {
+	// the bodies are destroyed together with the entities, which should
+	// not be reported as ended contacts anymore.
+	if (_b2_world) {
+		_b2_world->SetContactListener(nullptr);
+	}
 }
 
 void Level::AddWall(unsigned x, unsigned y) {
-	_AddEntity<Wall>(x, y);
+	Wall *wall = _walls.Acquire();
+
+	if (wall) {
+		wall->Respawn(x, y);
+	} else {
+		wall = _walls.Create(x, y);
+	}
+
+	_tiles.Set(x, y, wall->Handle());
 }
 
 void Level::AddShooter(unsigned x, unsigned y, float shootTime, float currentTime) {
-	std::shared_ptr<Shooter> shooter = _AddEntity<Shooter>(x, y, shootTime, currentTime);
-	_shooters.insert(shooter);
+	Shooter *shooter = _shooters.Create(x, y, shootTime, currentTime);
+	_tiles.Set(x, y, shooter->Handle());
+
+	shooter->Start(_time);
+	_Schedule(shooter->NextShotTime(), SHOOT, shooter->Handle());
+}
+
+void Level::SetWall(unsigned x, unsigned y, bool solid) {
+	Entity *tile = WallAt(x, y);
+
+	if (solid && !tile) {
+		AddWall(x, y);
+	} else if (!solid && tile) {
+		if (tile->GetType() == Entity::SHOOTER) {
+			// removed with the other dead shooters at the end of the tick
+			tile->Die();
+		} else {
+			_walls.Remove(static_cast<Wall *>(tile));
+		}
+
+		_tiles.Set(x, y, EntityHandle());
+	}
 }
 
 void Level::CreatePlayer(float x, float y) {
-	_player = _AddEntity<Player>(x, y);
-	_player_controller = std::make_shared<PlayerController>(*_player);
+	_player = std::unique_ptr<Player>(new Player(x, y));
+	_player->_SetHandle(_registry.Create(_player.get()));
+	_player->Initialize(_b2_world);
+	_player_controller = std::make_shared<PlayerController>(*_player, _commands);
 }
 
 void Level::SpawnBlockBullet(float x, float y, float vx, float vy) {
-	_AddEntity<Bullet>(x, y, vx, vy, glm::vec4 { 1.0f, 0.0, 0.0, 1.0f }, 1.0f, true, false);
+	_block_bullets.Spawn(x, y, vx, vy, false);
 }
 
 void Level::SpawnPlayerBullet(float x, float y, float vx, float vy, bool exploding) {
-	_AddEntity<Bullet>(x, y, vx, vy, glm::vec4 { 1.0f, 1.0, 0.0, 1.0f }, 1.0f, false, exploding);
+	_player_bullets.Spawn(x, y, vx, vy, exploding);
 }
 
 void Level::SpawnDiamond(float x, float y, float vx, float vy) {
-	_diamond = _AddEntity<Diamond>(x, y, vx, vy);
+	Diamond *diamond = _diamonds.Acquire();
+
+	if (diamond) {
+		diamond->Respawn(x, y, vx, vy);
+	} else {
+		diamond = _AddEntity(_diamonds, x, y, vx, vy);
+	}
+
+	_diamond = diamond->Handle();
+	_diamond_shooter = EntityHandle();
 }
 
 void Level::ShakeScreen(float power, float amplitude) {
@@ -76,84 +157,264 @@ void Level::ShakeScreen(const glm::vec2& direction, float power, float amplitude
 }
 
 void Level::ExplodeAt(float x, float y) {
-	b2Vec2 explosion { x, y };
-	float explosionDistance = 5.0f;
-
-	for (auto entity : _entities) {
-		if (!dynamic_cast<Bullet *>(entity.get())) {
-			continue;
-		}
+	_block_bullets.KillWithin({ x, y }, 5.0f);
+	_player_bullets.KillWithin({ x, y }, 5.0f);
+}
 
-		b2Vec2 position { entity->X(), entity->Y() };
-		b2Vec2 distanceVector = position - explosion;
+void Level::SetTickRate(float ticksPerSecond) {
+	float previousTickTime = _tick_time;
+	_tick_time = 1.0f / ticksPerSecond;
 
-		if (distanceVector.LengthSquared() <= explosionDistance * explosionDistance) {
-			entity->Die();
-		}
+	// the pending timers were converted to ticks of the previous length
+	for (const TimerWheel::Timer& timer : _timers.TakeAll()) {
+		float time = _time + float(timer.due - _tick) * previousTickTime;
+		_Schedule(time, _TimerKind(timer.kind), timer.entity);
 	}
 }
 
+void Level::SetMaxCatchUpTicks(unsigned ticks) {
+	_max_catch_up_ticks = ticks;
+}
+
+StepScheduler& Level::GetStepScheduler() {
+	return _step_scheduler;
+}
+
+void Level::SetActivityExtent(const glm::vec2& halfExtent) {
+	_activity_extent = halfExtent;
+}
+
+EntityBudget& Level::GetBudget() {
+	return _budget;
+}
+
+float Level::FireRate() const {
+	return _fire_rate;
+}
+
 bool Level::Update(float dt) {
-	if (_is_game_over) {
-		return false;
+	_accumulator += dt;
+
+	// run the simulation at a fixed rate, catching up at most a few ticks
+	unsigned ticks = 0;
+	while (_accumulator >= _tick_time && !_is_game_over) {
+		if (ticks == _max_catch_up_ticks) {
+			// too far behind, drop the remaining time instead of spiraling
+			_accumulator = std::fmod(_accumulator, _tick_time);
+			break;
+		}
+
+		_Tick(_tick_time);
+		_accumulator -= _tick_time;
+		ticks++;
 	}
 
+	return !_is_game_over;
+}
+
+void Level::_Tick(float dt) {
 	_time += dt;
+	_tick++;
 
 	if (_player_controller) {
 		// handle input
-		_player_controller->UpdatePlayer(dt);
+		_player_controller->UpdatePlayer(dt, *this);
 	}
 
-	// step the physics
-	for (int i = 0; i < 5; i++) {
-		_b2_world->Step(dt / 5.0f, 10, 10);
-	}
+	// put everything far away from the camera to sleep
+	_UpdateActivity();
+
+	// rebuild the colliders of the edited tiles
+	_tiles.UpdateColliders(_b2_world);
 
-	// check if a diamond needs to be spawned
-	if (_diamond == nullptr && _time > 5.0f && !_has_diamond) {
-		int index = std::uniform_int_distribution<int>(0, _shooters.size() - 1)(_rng);
-		std::unordered_set<std::shared_ptr<Shooter>>::const_iterator it(_shooters.begin());
-		std::advance(it, index);
+	// step the physics, in as many substeps as the fastest body needs
+	StepScheduler::Schedule schedule = _step_scheduler.Plan(*_b2_world, dt);
 
-		(*it)->SetNextAsDiamond();
-		_has_diamond = true;
+	for (unsigned i = 0; i < schedule.substeps; i++) {
+		_b2_world->Step(dt / schedule.substeps, schedule.velocity_iterations, schedule.position_iterations);
 	}
 
-	// update the entities
-	std::vector<std::shared_ptr<Entity>> deadEntities;
+	// respond to the contacts of the step
+	_contact_events.Prepare();
+	collision_matrix.Dispatch(_contact_events, _registry, _commands);
+	_contact_events.Clear();
 
-	for (auto entity : _entities) {
-		entity->Update(dt, *this);
+	// homing bullets aim at the player when they can see it, and follow
+	// the paths to the tile of the player otherwise
+	_visibility.Update(_tiles, int(std::round(_player->X())), int(std::round(_player->Y())), _activity_lower, _activity_upper);
+	_flow_field.Update(_tiles, int(std::round(_player->X())), int(std::round(_player->Y())));
 
-		if (!entity->IsAlive()) {
-			deadEntities.push_back(entity);
+	// simulate the bullets, block bullets can hit the player as well
+	_bullet_targets.clear();
+
+	for (Diamond *diamond : _diamonds) {
+		if (!diamond->IsDormant()) {
+			_bullet_targets.push_back(diamond);
 		}
 	}
 
+	_player_bullets.Update(dt, *this, _tiles, _bullet_targets, _commands);
+	_bullet_targets.push_back(_player.get());
+	_block_bullets.Update(dt, *this, _tiles, _bullet_targets, _commands);
+	_player_bullets.CollideWith(_block_bullets, _commands);
+
+	// perform everything that was postponed during the step and the
+	// bullet simulation
+	_commands.Execute(*this);
+
+	// run the timers that are due, like shooters that shoot
+	_timers.Advance(_tick, [this](const TimerWheel::Timer& timer) {
+		_OnTimer(timer);
+	});
+
+	// update the diamonds and the player, diamonds spawned in the process
+	// are updated as well. Walls and shooters are never updated, and the
+	// bullets were moved by their systems.
+	for (size_t i = 0; i < _diamonds.Size(); i++) {
+		_diamonds[i]->Update(dt, *this);
+	}
+
+	_player->Update(dt, *this);
+
+	_EnforceBudget();
+
 	// remove dead entities
-	for (auto dead : deadEntities) {
-		_entities.erase(dead);
+	if (!_player->IsAlive()) {
+		_is_game_over = true;
+	}
+
+	_shooters.RemoveDead();
+	_block_bullets.RemoveDead();
+	_player_bullets.RemoveDead();
+	_diamonds.RemoveDead();
 
-		if (dead == _diamond) {
-			_diamond = nullptr;
-			_has_diamond = false;
+	// the handle of a removed diamond is no longer valid
+	if (_diamond && !GetEntity(_diamond)) {
+		_diamond = EntityHandle();
+		_Schedule(_time, SPAWN_DIAMOND);
+	}
+
+	// a shooter removed before shooting its diamond passes it on
+	if (_diamond_shooter && !GetEntity(_diamond_shooter)) {
+		_diamond_shooter = EntityHandle();
+		_Schedule(_time, SPAWN_DIAMOND);
+	}
+}
+
+void Level::_UpdateActivity() {
+	_activity_lower = { _camera_x - _activity_extent.x, _camera_y - _activity_extent.y };
+	_activity_upper = { _camera_x + _activity_extent.x, _camera_y + _activity_extent.y };
+
+	const glm::vec2& lower = _activity_lower;
+	const glm::vec2& upper = _activity_upper;
+
+	auto isActive = [&](Entity *entity) {
+		return entity->X() >= lower.x && entity->X() <= upper.x && entity->Y() >= lower.y && entity->Y() <= upper.y;
+	};
+
+	for (Shooter *shooter : _shooters) {
+		shooter->SetDormant(!isActive(shooter));
+
+		// a shooter that became due while dormant shoots right away
+		if (!shooter->IsDormant() && shooter->Wake()) {
+			_Schedule(_time, SHOOT, shooter->Handle());
 		}
+	}
+
+	for (Diamond *diamond : _diamonds) {
+		diamond->SetDormant(!isActive(diamond));
+	}
+
+	_block_bullets.SetActivityRegion(lower, upper);
+	_player_bullets.SetActivityRegion(lower, upper);
+}
+
+void Level::_EnforceBudget() {
+	EntityBudget::Counters& counters = _budget.GetCounters();
+	size_t bullets = _block_bullets.AliveCount() + _player_bullets.AliveCount();
+
+	// merge the bullets the player can't see
+	if (bullets > _budget.MergeCount()) {
+		glm::vec2 center { _player->X(), _player->Y() };
+		size_t merged = _block_bullets.MergeDistant(center, _budget.MergeDistance(), _budget.MergeRadius(), _tiles);
+
+		counters.merged_bullets += merged;
+		bullets -= merged;
+	}
+
+	// recycle the oldest bullets, the player's own bullets are spared
+	if (bullets > _budget.MaxBullets()) {
+		size_t recycled = _block_bullets.RecycleOldest(bullets - _budget.MaxBullets());
+
+		counters.recycled_bullets += recycled;
+		bullets -= recycled;
+	}
+
+	// slow down the shooters for the next tick
+	_fire_rate = _budget.FireRate(bullets);
+
+	if (_fire_rate < 1.0f) {
+		counters.throttled_ticks++;
+	}
+}
+
+void Level::_Schedule(float time, _TimerKind kind, const EntityHandle& entity) {
+	// the tick at which the simulation reaches the time, counted from the
+	// current tick so earlier changes of the tick length don't matter
+	float ticks = std::max(std::ceil((time - _time) / _tick_time - 0.001f), 0.0f);
+	_timers.Schedule(_tick + uint64_t(ticks), entity, kind);
+}
+
+void Level::_OnTimer(const TimerWheel::Timer& timer) {
+	switch (timer.kind) {
+		case SHOOT:
+			if (Shooter *shooter = static_cast<Shooter *>(GetEntity(timer.entity))) {
+				if (shooter->Shoot(*this)) {
+					_Schedule(shooter->NextShotTime(), SHOOT, timer.entity);
+				}
+			}
+			break;
+		case SPAWN_DIAMOND: {
+			if (_shooters.Size() == 0) {
+				_Schedule(_time + 1.0f, SPAWN_DIAMOND);
+				break;
+			}
 
-		if (dead == _player) {
-			_is_game_over = true;
+			Shooter *shooter = _shooters[std::uniform_int_distribution<int>(0, _shooters.Size() - 1)(_rng)];
+			shooter->SetNextAsDiamond();
+			_diamond_shooter = shooter->Handle();
+			break;
 		}
 	}
+}
 
-	return !_is_game_over;
+void Level::UpdateView(const glm::ivec2& screenDimensions) {
+	_FollowPlayer({ _player->X(), _player->Y() });
+
+	// update the player controller without rendering anything
+	if (_player_controller) {
+		_player_controller->UpdateController(screenDimensions, { _camera_x, _camera_y, 1.75f });
+	}
 }
 
-void Level::Render(float dt, const glm::ivec2& screenDimensions) {
-	// let camera follow player
-	if (_camera_x < _player->X() - 5) { _camera_x = _player->X() - 5; }
-	if (_camera_x > _player->X() + 5) { _camera_x = _player->X() + 5; }
-	if (_camera_y < _player->Y() - 3) { _camera_y = _player->Y() - 3; }
-	if (_camera_y > _player->Y() + 3) { _camera_y = _player->Y() + 3; }
+void Level::Render(float dt, const glm::ivec2& screenDimensions, RenderQueue& queue) {
+	// interpolate between the last two ticks
+	float alpha = _accumulator / _tick_time;
+
+	_ForEachDynamicEntity([alpha](Entity *entity) {
+		entity->Interpolate(alpha);
+	});
+
+	_player->Interpolate(alpha);
+
+	// shooters show their charge at the interpolated time
+	float renderTime = _time + (alpha - 1.0f) * _tick_time;
+
+	for (Shooter *shooter : _shooters) {
+		shooter->SetRenderTime(renderTime);
+	}
+
+	_FollowPlayer(_player->RenderPosition());
 
 	glm::vec2 shake(0, 0);
 
@@ -176,15 +437,26 @@ void Level::Render(float dt, const glm::ivec2& screenDimensions) {
 	glm::vec3 cameraParams { _camera_x + shake.x, _camera_y + shake.y, 1.75f };
 //	glm::vec3 cameraParams { 5, 5, 1.75f };
 
-	for (std::shared_ptr<Entity> entity : _entities) {
+	FrameUniforms::Upload(screenDimensions, cameraParams);
+
+	// the walls are drawn from the tile map in one pass, only the arrows
+	// of the shooters are drawn as line art
+	_tile_renderer.Render(_tiles, queue);
+
+	_ForEachDynamicEntity([&](Entity *entity) {
 		if (entity->IsAlive()) {
-			entity->Render(screenDimensions, cameraParams);
+			entity->Render(_batch);
 		}
-	}
+	});
 
-	if (!_player->IsAlive()) {
-		_player->Render(screenDimensions, cameraParams);
-	}
+	_block_bullets.Render(_batch, alpha);
+	_player_bullets.Render(_batch, alpha);
+
+	// the player is rendered even when dead
+	_player->Render(_batch);
+
+	// draw everything with one call per mesh
+	_batch.Flush(queue);
 
 	// update the player controller
 	if (_player_controller) {
@@ -210,37 +482,36 @@ void Level::OnMouseButton(int button, int action, int mods) {
 	}
 }
 
-Entity *Level::Raycast(const glm::vec2& origin, const glm::vec2& direction, float tmin, float tmax, std::function<bool(Entity *)> predicate) {
-	b2RayCastInput input;
-	input.p1 = { origin.x, origin.y };
-	input.p2 = input.p1 + b2Vec2 { direction.x, direction.y };
-	input.maxFraction = tmax;
+void Level::_FollowPlayer(const glm::vec2& position) {
+	// let camera follow player
+	if (_camera_x < position.x - 5) { _camera_x = position.x - 5; }
+	if (_camera_x > position.x + 5) { _camera_x = position.x + 5; }
+	if (_camera_y < position.y - 3) { _camera_y = position.y - 3; }
+	if (_camera_y > position.y + 3) { _camera_y = position.y + 3; }
+}
 
-	float t = tmax + 1;
-	Entity *hit = nullptr;
+Entity *Level::Raycast(const glm::vec2& origin, const glm::vec2& direction, float tmin, float tmax) const {
+	return Raycast(origin, direction, tmin, tmax, [](Entity *) -> bool { return true; });
+}
 
-	for (auto entity : _entities) {
-		Entity *e = entity.get();
-		if (!predicate(e)) {
-			continue;
-		}
+float Level::Time() const {
+	return _time;
+}
 
-		auto body = entity->Body();
+const FlowField& Level::GetFlowField() const {
+	return _flow_field;
+}
 
-		for (const b2Fixture *fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext()) {
-			b2RayCastOutput output;
-			if (!fixture->RayCast(&output, input, 0)) {
-				continue;
-			}
+const VisibilityGrid& Level::GetVisibility() const {
+	return _visibility;
+}
 
-			if (output.fraction < t) {
-				t = output.fraction;
-				hit = e;
-			}
-		}
-	}
+Entity *Level::GetEntity(const EntityHandle& handle) const {
+	return _registry.Get(handle);
+}
 
-	return hit;
+Entity *Level::WallAt(int x, int y) const {
+	return _registry.Get(_tiles.At(x, y));
 }
 
 Player& Level::GetPlayer() {
@@ -255,12 +526,17 @@ bool Level::IsGameOver() {
 	return _is_game_over;
 }
 
-Level Level::GenerateLevel() {
-	Level level;
-	const Image& levelImage = Resources::level;
+std::shared_ptr<Level> Level::GenerateLevel() {
+	return GenerateLevel(Resources::level);
+}
+
+std::shared_ptr<Level> Level::GenerateLevel(const Image& levelImage) {
+	std::shared_ptr<Level> level = std::make_shared<Level>();
 
 	std::vector<glm::ivec2> shootingDirections;
 
+	level->_tiles.Resize(levelImage.Width(), levelImage.Height());
+
 	for (unsigned i = 0; i < levelImage.Width(); i++) {
 		for (unsigned j = 0; j < levelImage.Height(); j++) {
 			unsigned color = levelImage.At(i, j).RGBA();
@@ -272,11 +548,11 @@ Level Level::GenerateLevel() {
 			}
 
 			if (color == 0x000000) {
-				level.AddWall(i, j);
+				level->AddWall(i, j);
 			} else if (color == 0xFF0000) {
-				level.AddShooter(i, j, 1.0f, -3.9f);
+				level->AddShooter(i, j, 1.0f, -3.9f);
 			} else if (color == 0x0000FF) {
-				shootingDirections.push_back({ i, j });
+				shootingDirections.push_back({ int(i), int(j) });
 			} else {
 				std::cerr << "Invalid color: " << color << " @" << i << "," << j << std::endl;
 			}
@@ -284,7 +560,7 @@ Level Level::GenerateLevel() {
 	}
 
 	for (const auto& direction : shootingDirections) {
-		for (auto shooter : level._shooters) {
+		for (Shooter *shooter : level->_shooters) {
 			int dx = abs(shooter->X() - direction.x);
 			int dy = abs(shooter->Y() - direction.y);
 
@@ -294,7 +570,8 @@ Level Level::GenerateLevel() {
 		}
 	}
 
-	level.CreatePlayer(2.0f, 5.0f);
+	level->_tiles.UpdateColliders(level->_b2_world);
+	level->CreatePlayer(2.0f, 5.0f);
 
 	return level;
 }
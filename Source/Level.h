@@ -5,24 +5,55 @@
 #ifndef LEVEL_H_
 #define LEVEL_H_
 
-#include <type_traits>
+#include <cmath>
+#include <memory>
 #include <unordered_set>
 #include <random>
 
 #include <Box2D/Box2D.h>
 
+#include "BulletSystem.h"
+#include "CommandBuffer.h"
+#include "ContactEvents.h"
 #include "Diamond.h"
+#include "EntityBudget.h"
+#include "EntityStorage.h"
+#include "FlowField.h"
+#include "LineBatch.h"
 #include "PlayerController.h"
+#include "RenderQueue.h"
 #include "ScreenShaker.h"
 #include "Shooter.h"
+#include "StepScheduler.h"
+#include "TileMap.h"
+#include "TileRenderer.h"
+#include "TimerWheel.h"
+#include "VisibilityGrid.h"
 
 class Level {
 
 public:
 	Level();
+	~Level();
 
+	// Box2D and the player controller keep pointers into the level
+	Level(const Level&) = delete;
+	Level& operator=(const Level&) = delete;
+
+	/*
+	 * Walls and shooters are tiles, their colliders are built before the
+	 * next physics step.
+	 */
 	void AddWall(unsigned x, unsigned y);
 	void AddShooter(unsigned x, unsigned y, float shootTime, float currentTime);
+
+	/**
+	 * Adds or removes the wall at a tile while playing. Only the colliders
+	 * of the regions around the chunk of the tile are rebuilt, before the
+	 * next step.
+	 * Removing a shooter tile kills the shooter.
+	 */
+	void SetWall(unsigned x, unsigned y, bool solid);
 	void CreatePlayer(float x, float y);
 	void SpawnBlockBullet(float x, float y, float vx, float vy);
 	void SpawnPlayerBullet(float x, float y, float vx, float vy, bool exploding);
@@ -32,53 +63,191 @@ public:
 	void ShakeScreen(const glm::vec2& direction, float power, float amplitude);
 	void ExplodeAt(float x, float y);
 
+	void SetTickRate(float ticksPerSecond);
+	void SetMaxCatchUpTicks(unsigned ticks);
+	StepScheduler& GetStepScheduler();
+
+	/**
+	 * Sets the half size of the region around the camera in which entities
+	 * are simulated. Shooters, diamonds and bullets outside of it go dormant,
+	 * and dormant bullets aren't drawn, so it should cover the view.
+	 */
+	void SetActivityExtent(const glm::vec2& halfExtent);
+
+	EntityBudget& GetBudget();
+
+	/**
+	 * The rate at which shooters charge, lowered by the budget when there
+	 * are too many bullets.
+	 */
+	float FireRate() const;
+
 	bool Update(float dt);
-	void Render(float dt, const glm::ivec2& screenDimensions);
+	void UpdateView(const glm::ivec2& screenDimensions);
+	void Render(float dt, const glm::ivec2& screenDimensions, RenderQueue& queue);
 
 	void OnKey(int key, int scancode, int action, int mods);
 	void OnMouseMove(float x, float y);
 	void OnMouseButton(int button, int action, int mods);
 
-	Entity *Raycast(const glm::vec2& origin, const glm::vec2& direction, float tmin, float tmax,
-			std::function<bool(Entity *)> predicate = [](Entity *) -> bool { return true; });
-
+	/**
+	 * Finds the closest entity hit by the ray origin + t * direction, for
+	 * tmin <= t <= tmax, for which the predicate returns true. Returns
+	 * nullptr if no such entity is hit.
+	 */
+	template<typename Predicate>
+	Entity *Raycast(const glm::vec2& origin, const glm::vec2& direction, float tmin, float tmax, Predicate predicate) const;
+	Entity *Raycast(const glm::vec2& origin, const glm::vec2& direction, float tmin, float tmax) const;
+
+	float Time() const;
+	const FlowField& GetFlowField() const;
+	const VisibilityGrid& GetVisibility() const;
+	Entity *GetEntity(const EntityHandle& handle) const;
+	Entity *WallAt(int x, int y) const;
 	Player& GetPlayer();
 	std::mt19937_64& RNG();
 	bool IsGameOver();
 
 private:
+	template<typename Predicate>
+	class _RaycastCallback : public b2RayCastCallback {
+
+	public:
+		_RaycastCallback(const EntityRegistry& registry, const TileMap& tiles, Predicate& predicate, float tmin, float tmax) :
+				hit(nullptr), _registry(registry), _tiles(tiles), _predicate(predicate), _min_fraction(tmin / tmax) {}
+
+		float32 ReportFixture(b2Fixture *fixture, const b2Vec2& point, const b2Vec2& normal, float32 fraction) {
+			EntityHandle handle = EntityHandle::FromUserData(fixture->GetUserData());
+
+			if (_tiles.IsCollider(fixture)) {
+				// a merged collider, find the tile just behind the point
+				handle = _tiles.At(point - 0.05f * normal);
+			}
+
+			Entity *entity = _registry.Get(handle);
+
+			if (fraction < _min_fraction || !entity || !_predicate(entity)) {
+				// ignore this fixture and continue
+				return -1.0f;
+			}
+
+			// clip the ray, so only closer fixtures are reported after this
+			hit = entity;
+			return fraction;
+		}
+
+		Entity *hit;
+
+	private:
+		const EntityRegistry& _registry;
+		const TileMap& _tiles;
+		Predicate& _predicate;
+		float _min_fraction;
+
+	};
+
+	enum _TimerKind : uint32_t {
+		SHOOT,
+		SPAWN_DIAMOND
+	};
+
+	void _Tick(float dt);
+	void _Schedule(float time, _TimerKind kind, const EntityHandle& entity = EntityHandle());
+	void _OnTimer(const TimerWheel::Timer& timer);
+	void _UpdateActivity();
+	void _EnforceBudget();
+	void _FollowPlayer(const glm::vec2& position);
+
 	template<typename T, typename ... Args>
-	std::shared_ptr<T> _AddEntity(Args ... args) {
-		static_assert(std::is_base_of<Entity, T>::value, "Entity instance must derive from Entity");
-		std::shared_ptr<T> entity = std::make_shared<T>(args ...);
+	T *_AddEntity(EntityStorage<T>& storage, Args ... args) {
+		T *entity = storage.Create(args ...);
 		entity->Initialize(_b2_world);
-		_entities.insert(entity);
 		return entity;
 	}
 
+	template<typename Function>
+	void _ForEachDynamicEntity(Function function) {
+		for (Shooter *shooter : _shooters) {
+			function(shooter);
+		}
+
+		for (Diamond *diamond : _diamonds) {
+			function(diamond);
+		}
+	}
+
 	std::mt19937_64 _rng;
 	std::uniform_real_distribution<float> _unit_distribution;
 
-	std::unordered_set<std::shared_ptr<Entity>> _entities;
-	std::unordered_set<std::shared_ptr<Shooter>> _shooters;
-	std::shared_ptr<Player> _player;
-	std::shared_ptr<PlayerController> _player_controller;
-	std::shared_ptr<Diamond> _diamond;
-	bool _has_diamond = false;
-
 	std::shared_ptr<b2World> _b2_world;
 	std::shared_ptr<b2ContactListener> _b2_contact_listener;
 
+	EntityRegistry _registry;
+	TileMap _tiles;
+	FlowField _flow_field;
+	VisibilityGrid _visibility;
+
+	LineBatch _batch;
+	TileRenderer _tile_renderer;
+	CommandBuffer _commands;
+	ContactEvents _contact_events;
+
+	// walls never move, so they are never updated
+	EntityStorage<Wall> _walls;
+
+	// the dynamic entities
+	EntityStorage<Shooter> _shooters;
+	BulletSystem _block_bullets;
+	BulletSystem _player_bullets;
+	std::vector<Entity *> _bullet_targets;
+	EntityStorage<Diamond> _diamonds;
+	std::unique_ptr<Player> _player;
+
+	std::shared_ptr<PlayerController> _player_controller;
+	EntityHandle _diamond;
+
+	// the shooter that shoots the next diamond, until it does
+	EntityHandle _diamond_shooter;
+
 	float _camera_x;
 	float _camera_y;
+	glm::vec2 _activity_extent { 24.0f, 16.0f };
+	glm::vec2 _activity_lower;
+	glm::vec2 _activity_upper;
 	std::unordered_set<std::shared_ptr<ScreenShaker>> _screen_shakers;
 
 	float _time = 0.0f;
+
+	// the number of ticks simulated, the clock of the timers
+	uint64_t _tick = 0;
+	TimerWheel _timers;
 	bool _is_game_over = false;
 
+	float _tick_time = 1.0f / 60.0f;
+	unsigned _max_catch_up_ticks = 5;
+	StepScheduler _step_scheduler;
+	EntityBudget _budget;
+	float _fire_rate = 1.0f;
+	float _accumulator = 0.0f;
+
 public:
-	static Level GenerateLevel();
+	static std::shared_ptr<Level> GenerateLevel();
+	static std::shared_ptr<Level> GenerateLevel(const Image& levelImage);
 
 };
 
+template<typename Predicate>
+Entity *Level::Raycast(const glm::vec2& origin, const glm::vec2& direction, float tmin, float tmax, Predicate predicate) const {
+	b2Vec2 p1 { origin.x, origin.y };
+	b2Vec2 p2 = p1 + tmax * b2Vec2 { direction.x, direction.y };
+
+	if (p1 == p2) {
+		return nullptr;
+	}
+
+	_RaycastCallback<Predicate> callback(_registry, _tiles, predicate, tmin, tmax);
+	_b2_world->RayCast(&callback, p1, p2);
+	return callback.hit;
+}
+
 #endif
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "LineBatch.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "FrameUniforms.h"
+
+std::vector<LineBatch::_Mesh> LineBatch::_meshes;
+ShaderProgram LineBatch::_shader;
+bool LineBatch::_is_shader_prepared = false;
+
+LineBatch::Mesh LineBatch::CreateMesh(GLenum mode, const std::vector<GLfloat>& vertices) {
+	_PrepareShader();
+
+	_Mesh mesh { mode, GLsizei(vertices.size() / 2), GL::GenVertexArray(), GL::GenBuffer(), GL::GenBuffer(), 0 };
+
+	GLState::BindVertexArray(mesh.vao);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void *) 0);
+
+	// the instance attributes advance once per instance
+	glBindBuffer(GL_ARRAY_BUFFER, mesh.instance_vbo);
+
+	struct Attribute {
+		GLint size;
+		size_t offset;
+	};
+
+	const Attribute attributes[] = {
+		{ 2, offsetof(Instance, location) },
+		{ 1, offsetof(Instance, rotation) },
+		{ 2, offsetof(Instance, rotation_center) },
+		{ 1, offsetof(Instance, scale) },
+		{ 4, offsetof(Instance, color) }
+	};
+
+	GLuint index = 1;
+	for (const Attribute& attribute : attributes) {
+		glEnableVertexAttribArray(index);
+		glVertexAttribPointer(index, attribute.size, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *) attribute.offset);
+		glVertexAttribDivisor(index, 1);
+		index++;
+	}
+
+	GLState::BindVertexArray(0);
+
+	_meshes.push_back(mesh);
+	return _meshes.size() - 1;
+}
+
+void LineBatch::Add(Mesh mesh, const Instance& instance) {
+	if (_instances.size() <= mesh) {
+		_instances.resize(mesh + 1);
+	}
+
+	_instances[mesh].push_back(instance);
+}
+
+void LineBatch::Flush(RenderQueue& queue) {
+	_PrepareShader();
+
+	for (Mesh i = 0; i < _instances.size(); i++) {
+		std::vector<Instance>& instances = _instances[i];
+
+		if (instances.empty()) {
+			continue;
+		}
+
+		_Mesh& mesh = _meshes[i];
+		glBindBuffer(GL_ARRAY_BUFFER, mesh.instance_vbo);
+
+		// orphan the buffer every frame, so the driver doesn't have to wait
+		// until the previous frame is done with it
+		size_t size = instances.size() * sizeof(Instance);
+		mesh.instance_capacity = std::max(mesh.instance_capacity, size);
+		glBufferData(GL_ARRAY_BUFFER, mesh.instance_capacity, nullptr, GL_STREAM_DRAW);
+
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances.data());
+
+		queue.Submit(RenderQueue::LINES, { &_shader, (GLuint) mesh.vao, 0, mesh.mode, mesh.count, GLsizei(instances.size()), nullptr });
+
+		instances.clear();
+	}
+}
+
+void LineBatch::_PrepareShader() {
+	if (_is_shader_prepared) {
+		return;
+	}
+
+	_shader.AddShaderFromFile(GL_VERTEX_SHADER, "Resources/line.vert.glsl");
+	_shader.AddShaderFromFile(GL_FRAGMENT_SHADER, "Resources/line.frag.glsl");
+	FrameUniforms::AddTo(_shader);
+	_shader.Link();
+
+	_is_shader_prepared = true;
+}
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef LINEBATCH_H_
+#define LINEBATCH_H_
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "GL.h"
+#include "RenderQueue.h"
+#include "ShaderProgram.h"
+
+/**
+ * Draws the line art of the entities. Entities add an instance of their mesh
+ * while rendering, Flush() then streams the instances of each mesh to the
+ * GPU and draws them with a single instanced draw call.
+ */
+class LineBatch {
+
+public:
+	using Mesh = unsigned;
+
+	struct Instance {
+		glm::vec2 location;
+		float rotation;
+		glm::vec2 rotation_center;
+		float scale;
+		glm::vec4 color;
+	};
+
+	/**
+	 * Creates a mesh from the vertices (x, y pairs) of its lines, drawn in
+	 * the given mode. Meshes are shared by all batches. They are drawn in
+	 * the LINES layer of the RenderQueue, which orders them by state, so
+	 * line art should not depend on the order of the meshes.
+	 */
+	static Mesh CreateMesh(GLenum mode, const std::vector<GLfloat>& vertices);
+
+	void Add(Mesh mesh, const Instance& instance);
+	/**
+	 * Uploads and clears the instances, and submits a command to draw the
+	 * instances of each mesh, with the current FrameUniforms.
+	 */
+	void Flush(RenderQueue& queue);
+
+private:
+	struct _Mesh {
+		GLenum mode;
+		GLsizei count;
+		GLhandle vao;
+		GLhandle vbo;
+		GLhandle instance_vbo;
+		size_t instance_capacity;
+	};
+
+	std::vector<std::vector<Instance>> _instances;
+
+	static void _PrepareShader();
+
+	static std::vector<_Mesh> _meshes;
+	static ShaderProgram _shader;
+	static bool _is_shader_prepared;
+
+};
+
+#endif
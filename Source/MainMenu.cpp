@@ -4,8 +4,8 @@
 
 #include "MainMenu.h"
 
-void MainMenu::Render(const glm::ivec2& screenDimensions) {
-	_InitializeScreenDimensions(screenDimensions);
+void MainMenu::Render(const glm::ivec2& screenDimensions, RenderQueue& queue) {
+	_InitializeScreenDimensions(screenDimensions, queue);
 
 	float size = (800.0f / float(screenDimensions.x)) * (float(screenDimensions.x) / (screenDimensions.y));
 	float x = float(screenDimensions.x) / (screenDimensions.y);
@@ -10,7 +10,7 @@
 class MainMenu : public UI {
 
 public:
-	void Render(const glm::ivec2& screenDimensions);
+	void Render(const glm::ivec2& screenDimensions, RenderQueue& queue);
 
 };
 
@@ -7,8 +7,8 @@
 Overlay::Overlay(Level& level) :
 		_level(level) {}
 
-void Overlay::Render(const glm::ivec2& screenDimensions) {
-	_InitializeScreenDimensions(screenDimensions);
+void Overlay::Render(const glm::ivec2& screenDimensions, RenderQueue& queue) {
+	_InitializeScreenDimensions(screenDimensions, queue);
 
 	// draw the background
 	_SetColor({ 0.0f, 0.0f, 0.0f, 0.9f });
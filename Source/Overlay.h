@@ -12,7 +12,7 @@ class Overlay : public UI {
 public:
 	Overlay(Level& level);
 
-	void Render(const glm::ivec2& screenDimensions);
+	void Render(const glm::ivec2& screenDimensions, RenderQueue& queue);
 
 private:
 	Level& _level;
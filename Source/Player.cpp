@@ -10,79 +10,86 @@
 #include "Diamond.h"
 #include "Level.h"
 
+LineBatch::Mesh Player::_mesh;
+bool Player::_is_renderer_prepared = false;
+
 Player::Player(float x, float y) :
-		Entity(x, y, 0.0f),
-		_display_bullet(std::make_shared<Bullet>(0, 0, 0, 0, glm::vec4 { 1.0f, 1.0f, 0.0f, 1.0f }, 0.5f, false, false)) {}
+		Entity(PLAYER, x, y, 0.0f) {}
 
-void Player::Render(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) const {
+void Player::Render(LineBatch& batch) const {
 	_PrepareRenderer();
 
-	_line_shader.Use();
-	_line_shader["screenDimensions"] = (glm::vec2) screenDimensions;
-	_line_shader["location"] = glm::vec2 { _x, _y - 0.07f };
-	_line_shader["color"] = glm::vec4 { 1.0f, 0.0f, 1.0f, 1.0f };
-	_line_shader["rotation"] = _rotation;
-	_line_shader["rotationCenter"] = glm::vec2 { 0.50f, 0.43f };
-	_line_shader["cameraParams"] = cameraParams;
-	_line_shader["scale"] = 1.0f;
-
-	glBindVertexArray(_vao);
-	glDrawArrays(GL_LINE_STRIP, 0, _count);
-	glBindVertexArray(0);
+	batch.Add(_mesh, {
+		{ _render_x, _render_y - 0.07f }, _render_rotation, { 0.50f, 0.43f }, 1.0f,
+		{ 1.0f, 0.0f, 1.0f, 1.0f }
+	});
 
 	// render the bullets
-	float rotation = _rotation;
+	float rotation = _render_rotation;
 	for (unsigned i = 0; i < _bullet_count; i++) {
-		_display_bullet->X() = _x + 0.25f * cos(rotation) + 0.25f;
-		_display_bullet->Y() = _y + 0.25f * sin(rotation) - 0.25f;
-		_display_bullet->Render(screenDimensions, cameraParams);
+		Bullet::Draw(batch, {
+			_render_x + 0.25f * cos(rotation) + 0.25f,
+			_render_y + 0.25f * sin(rotation) - 0.25f
+		}, { 1.0f, 1.0f, 0.0f, 1.0f }, 0.5f);
 
 		rotation += M_PI / 3.0f;
 	}
 }
 
-void Player::OnCollisionStart(Entity *other, b2Contact *contact) {
-	Wall *wall = dynamic_cast<Wall *>(other);
-	Bullet *bullet = dynamic_cast<Bullet *>(other);
-	Diamond *diamond = dynamic_cast<Diamond *>(other);
-
-	if (wall) {
-		_touching_walls.insert(wall);
-	} else if (bullet) {
-		_bullet_count++;
+void Player::OnTouchWall(Entity& player, Entity& wall, const ContactEvents::Contact& contact, CommandBuffer& commands) {
+	static_cast<Player&>(player)._touching_walls.insert(wall.Handle());
+}
 
-		if (_hp >= 1) {
-			_hp--;
-		}
+void Player::OnLeaveWall(Entity& player, Entity& wall, const ContactEvents::Contact& contact, CommandBuffer& commands) {
+	static_cast<Player&>(player)._touching_walls.erase(wall.Handle());
+}
 
-		_on_update.push_back([wall](Entity &p, Level &l) {
-			l.ShakeScreen(50.0f, 0.1f);
-		});
-	} else if (diamond) {
-		diamond->Die();
+void Player::HitByBullet(CommandBuffer& commands) {
+	_bullet_count++;
 
-		_score++;
-		_hp = max_hp;
+	if (_hp >= 1) {
+		_hp--;
 	}
 
+	commands.ShakeScreen(50.0f, 0.1f);
+
 	if (_hp == 0 || _bullet_count > 6) {
-		Die();
+		commands.Die(Handle());
 	}
 }
 
-void Player::OnCollisionEnd(Entity *other, b2Contact *contact) {
-	Wall *wall = dynamic_cast<Wall *>(other);
+void Player::OnTouchDiamond(Entity& player, Entity& diamond, const ContactEvents::Contact& contact, CommandBuffer& commands) {
+	Player& self = static_cast<Player&>(player);
+	commands.Die(diamond.Handle());
+
+	self._score++;
+	self._hp = max_hp;
+}
 
-	if (wall) {
-		_touching_walls.erase(wall);
+void Player::InternalUpdate(float dt, Level& level) {
+	// forget walls that were removed while touching them, their ended
+	// contacts can't be resolved anymore
+	for (auto it = _touching_walls.begin(); it != _touching_walls.end();) {
+		if (level.GetEntity(*it)) {
+			it++;
+		} else {
+			it = _touching_walls.erase(it);
+		}
 	}
 }
 
-bool Player::IsGrouded() const {
-	for (Wall *wall : _touching_walls) {
-		if (_y <= wall->Y() + 0.42f &&
-				_x - 0.5f <= wall->X() && wall->X() <= _x + 0.5f) {
-			return true;
+bool Player::IsGrouded(const Level& level) const {
+	// the colliders of the walls are merged, so check the tiles around the
+	// player once it touches any of them
+	if (_touching_walls.empty()) {
+		return false;
+	}
+
+	for (int y = int(std::ceil(_y - 0.42f)); y <= int(std::floor(_y + 1.0f)); y++) {
+		for (int x = int(std::ceil(_x - 0.5f)); x <= int(std::floor(_x + 0.5f)); x++) {
+			if (level.WallAt(x, y)) {
+				return true;
+			}
 		}
 	}
 
@@ -122,14 +129,12 @@ void Player::_CreateFixture(std::shared_ptr<b2Body> body) const {
 	fixture->SetRestitution(0.0f);
 }
 
-void Player::_PrepareRenderer() const {
-	_PrepareShader();
-
+void Player::_PrepareRenderer() {
 	if (_is_renderer_prepared) {
 		return;
 	}
 
-	// prepare the VAO/VBO for rendering
+	// prepare the mesh for rendering
 	std::vector<GLfloat> data = {
 			0.25f, 0.00f,
 			0.50f, 0.21f,
@@ -155,19 +160,7 @@ void Player::_PrepareRenderer() const {
 //			0.25f, 0.00f
 	};
 
-	_count = data.size() / 2;
-
-	_vao = GL::GenVertexArray();
-	_vbo = GL::GenBuffer();
-
-	glBindVertexArray(_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(GLfloat), data.data(), GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void *) 0);
-
-	glBindVertexArray(0);
+	_mesh = LineBatch::CreateMesh(GL_LINE_STRIP, data);
 
 	_is_renderer_prepared = true;
 }
@@ -6,9 +6,9 @@
 #define PLAYER_H_
 
 #include <set>
-#include <functional>
 
-#include "Bullet.h"
+#include "CommandBuffer.h"
+#include "ContactEvents.h"
 #include "Wall.h"
 
 class Player : public Entity {
@@ -18,32 +18,36 @@ public:
 	Player(float x, float y);
 	~Player() = default;
 
-	void Render(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) const;
+	void Render(LineBatch& batch) const;
 
-	void OnCollisionStart(Entity *other, b2Contact *contact);
-	void OnCollisionEnd(Entity *other, b2Contact *contact);
-	bool IsGrouded() const;
+	bool IsGrouded(const Level& level) const;
+
+	void HitByBullet(CommandBuffer& commands);
 
 	unsigned Score() const;
 	unsigned Health() const;
 
 protected:
+	void InternalUpdate(float dt, Level& level);
+
 	b2BodyDef _CreateBody() const;
 	void _CreateFixture(std::shared_ptr<b2Body> body) const;
 
 public:
 	static constexpr unsigned max_hp = 20;
 
+	// collision responses, see CollisionMatrix
+	static void OnTouchWall(Entity& player, Entity& wall, const ContactEvents::Contact& contact, CommandBuffer& commands);
+	static void OnLeaveWall(Entity& player, Entity& wall, const ContactEvents::Contact& contact, CommandBuffer& commands);
+	static void OnTouchDiamond(Entity& player, Entity& diamond, const ContactEvents::Contact& contact, CommandBuffer& commands);
+
 private:
-	void _PrepareRenderer() const;
+	static void _PrepareRenderer();
 
-	mutable GLhandle _vao;
-	mutable GLhandle _vbo;
-	mutable unsigned _count = 0;
-	mutable bool _is_renderer_prepared = false;
+	static LineBatch::Mesh _mesh;
+	static bool _is_renderer_prepared;
 
-	std::set<Wall *> _touching_walls;
-	std::shared_ptr<Bullet> _display_bullet;
+	std::set<EntityHandle> _touching_walls;
 	unsigned _bullet_count = 0;
 
 	unsigned _score = 0;
@@ -10,8 +10,8 @@
 
 #include "Level.h"
 
-PlayerController::PlayerController(Player &player) :
-		_player(player) {}
+PlayerController::PlayerController(Player &player, CommandBuffer& commands) :
+		_player(player), _commands(commands) {}
 
 void PlayerController::OnKey(int key, int scancode, int action, int mods) {
 	if (action == GLFW_PRESS) {
@@ -46,14 +46,7 @@ void PlayerController::OnMouseButton(int button, int action, int mods) {
 	bool exploding = abs(_player._b2_body->GetAngularVelocity()) > 15;
 
 	// spawn the bullet on next update
-	_player._on_update.push_back([pos, exploding](Entity& e, Level& l) {
-		glm::vec2 direction = pos;
-		direction.x -= e.X();
-		direction.y -= e.Y() - 0.5f;
-		direction /= sqrt(direction.x * direction.x + direction.y * direction.y);
-
-		l.SpawnPlayerBullet(e.X() + direction.x * 0.8f, e.Y() + direction.y * 0.8f, direction.x * 10.0f, direction.y * 10.0f, exploding);
-	});
+	_commands.SpawnPlayerBullet(_player.Handle(), pos, exploding);
 
 	_player._bullet_count--;
 }
@@ -63,17 +56,19 @@ void PlayerController::UpdateController(const glm::ivec2& screenDimensions, cons
 	_camera_params = cameraParams;
 }
 
-void PlayerController::UpdatePlayer(float dt) {
-	_HandleJumping(dt);
-	_HandleLateral(dt);
+void PlayerController::UpdatePlayer(float dt, const Level& level) {
+	bool grounded = _player.IsGrouded(level);
+
+	_HandleJumping(dt, grounded);
+	_HandleLateral(dt, grounded);
 }
 
-void PlayerController::_HandleJumping(float dt) {
+void PlayerController::_HandleJumping(float dt, bool grounded) {
 	_grounded_timer -= dt;
 	_jump_pressed_timer -= dt;
 	_jump_cooldown_timer -= dt;
 
-	if (_player.IsGrouded()) {
+	if (grounded) {
 		_grounded_timer = _grounded_timer_value;
 	}
 
@@ -89,7 +84,7 @@ void PlayerController::_HandleJumping(float dt) {
 	}
 }
 
-void PlayerController::_HandleLateral(float dt) {
+void PlayerController::_HandleLateral(float dt, bool grounded) {
 	float velocity = _player._b2_body->GetLinearVelocity().x;
 
 	float addedVelocity = 0.0f;
@@ -114,7 +109,7 @@ void PlayerController::_HandleLateral(float dt) {
 		velocity *= std::pow(1.0f - _damping_grounded, dt * 10.0f);
 	}
 
-	if (!_player.IsGrouded()) {
+	if (!grounded) {
 		velocity *= std::pow(1.0f - _damping_air_extra, dt * 10.0f);
 	}
 
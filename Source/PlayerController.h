@@ -9,29 +9,32 @@
 
 #include "Player.h"
 
+class Level;
+
 class PlayerController {
 
 public:
-	PlayerController(Player &player);
+	PlayerController(Player &player, CommandBuffer& commands);
 
 	void OnKey(int key, int scancode, int action, int mods);
 	void OnMouseMove(float x, float y);
 	void OnMouseButton(int button, int action, int mods);
 
 	void UpdateController(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams);
-	void UpdatePlayer(float dt);
+	void UpdatePlayer(float dt, const Level& level);
 
 private:
 	enum Key {
 		JUMP, LEFT, RIGHT
 	};
 
-	void _HandleJumping(float dt);
-	void _HandleLateral(float dt);
+	void _HandleJumping(float dt, bool grounded);
+	void _HandleLateral(float dt, bool grounded);
 
 	bool _KeyPressed(Key key) const;
 
 	Player &_player;
+	CommandBuffer& _commands;
 	std::set<int> _pressed_keys;
 
 	glm::vec2 _mouse_position;
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "RenderQueue.h"
+
+#include <chrono>
+
+#include "GLState.h"
+
+void RenderQueue::Submit(Layer layer, const Command& command, std::initializer_list<glm::vec4> uniforms) {
+	uint32_t sequence = _entries.size();
+
+	_keys.push_back({ _Key(layer, command, sequence), sequence });
+	_entries.push_back({ command, uint32_t(_uniforms.size()) });
+	_uniforms.insert(_uniforms.end(), uniforms.begin(), uniforms.end());
+}
+
+void RenderQueue::Execute() {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	_Sort();
+
+	auto sorted = std::chrono::high_resolution_clock::now();
+
+	for (const auto& key : _keys) {
+		const _Entry& entry = _entries[key.second];
+		const Command& command = entry.command;
+
+		command.program->Use();
+		GLState::BindVertexArray(command.vao);
+
+		if (command.texture) {
+			GLState::BindTexture(0, command.texture);
+		}
+
+		if (command.apply) {
+			command.apply(&_uniforms[entry.uniforms]);
+		}
+
+		if (command.instances > 0) {
+			glDrawArraysInstanced(command.mode, 0, command.count, command.instances);
+		} else {
+			glDrawArrays(command.mode, 0, command.count);
+		}
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+
+	_stats.commands = _entries.size();
+	_stats.sort_time = std::chrono::duration<float>(sorted - start).count();
+	_stats.execute_time = std::chrono::duration<float>(end - sorted).count();
+
+	_entries.clear();
+	_uniforms.clear();
+	_keys.clear();
+}
+
+const RenderQueue::Stats& RenderQueue::LastStats() const {
+	return _stats;
+}
+
+uint64_t RenderQueue::_Key(Layer layer, const Command& command, uint32_t sequence) {
+	// layer (8 bits) | program (16 bits) | mesh (20 bits) | texture (20 bits),
+	// or layer | submission order for layers that keep their order
+	uint64_t key = uint64_t(layer) << 56;
+
+	if (layer == UI) {
+		return key | sequence;
+	}
+
+	return key
+			| uint64_t(command.program->Id() & 0xFFFF) << 40
+			| uint64_t(command.vao & 0xFFFFF) << 20
+			| uint64_t(command.texture & 0xFFFFF);
+}
+
+void RenderQueue::_Sort() {
+	if (_keys.size() < 2) {
+		return;
+	}
+
+	_scratch.resize(_keys.size());
+
+	for (unsigned shift = 0; shift < 64; shift += 8) {
+		size_t counts[256] = {};
+
+		for (const auto& key : _keys) {
+			counts[(key.first >> shift) & 0xFF]++;
+		}
+
+		// skip the byte when all keys share it
+		if (counts[(_keys[0].first >> shift) & 0xFF] == _keys.size()) {
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t& count : counts) {
+			size_t c = count;
+			count = offset;
+			offset += c;
+		}
+
+		for (const auto& key : _keys) {
+			_scratch[counts[(key.first >> shift) & 0xFF]++] = key;
+		}
+
+		_keys.swap(_scratch);
+	}
+}
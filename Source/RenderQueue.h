@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "GL.h"
+#include "ShaderProgram.h"
+
+/**
+ * The draw calls of a frame. Renderers submit commands instead of drawing
+ * right away, and Execute() sorts them on a 64 bit key and draws them in
+ * one pass, so commands that share a program, mesh or texture are drawn
+ * after each other and the draw order no longer depends on the order the
+ * entities happen to be stored in.
+ */
+class RenderQueue {
+
+public:
+	/*
+	 * Layers are drawn in this order. Within the UI layer the commands are
+	 * drawn in the order they were submitted, since they overlap, within the
+	 * other layers they are grouped by state.
+	 */
+	enum Layer : uint8_t {
+		WALLS,
+		LINES,
+		UI
+	};
+
+	struct Command {
+		const ShaderProgram *program;
+		GLuint vao;
+		GLuint texture;
+		GLenum mode;
+		GLsizei count;
+
+		// draws without instancing when 0
+		GLsizei instances;
+
+		// sets the uniforms of the command from the values it was
+		// submitted with, when not null
+		void (*apply)(const glm::vec4 *uniforms);
+	};
+
+	struct Stats {
+		unsigned commands = 0;
+		float sort_time = 0.0f;
+		float execute_time = 0.0f;
+	};
+
+	void Submit(Layer layer, const Command& command, std::initializer_list<glm::vec4> uniforms = {});
+
+	/**
+	 * Sorts and draws the commands, and clears the queue for the next frame.
+	 */
+	void Execute();
+
+	/*
+	 * The number of commands and the time spent on them in the last frame.
+	 */
+	const Stats& LastStats() const;
+
+private:
+	struct _Entry {
+		Command command;
+		uint32_t uniforms;
+	};
+
+	static uint64_t _Key(Layer layer, const Command& command, uint32_t sequence);
+
+	/*
+	 * LSD radix sort of the keys, one byte per pass, which keeps commands
+	 * with equal keys in the order they were submitted.
+	 */
+	void _Sort();
+
+	std::vector<_Entry> _entries;
+	std::vector<glm::vec4> _uniforms;
+	std::vector<std::pair<uint64_t, uint32_t>> _keys;
+	std::vector<std::pair<uint64_t, uint32_t>> _scratch;
+
+	Stats _stats;
+
+};
+
+#endif
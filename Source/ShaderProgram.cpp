@@ -4,13 +4,12 @@
 
 #include "ShaderProgram.h"
 
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <fstream>
 #include <streambuf>
 
-GLuint ShaderProgramBindings::programInUse = 0;
-
 void ShaderProgram::Link() {
 	// create the OpenGL program
 	_program_id = GL::CreateProgram();
@@ -55,6 +54,43 @@ void ShaderProgram::Link() {
 		glDetachShader(_program_id, shader);
 		glDeleteShader(shader);
 	}
+
+	// resolve the locations of the active uniforms now, instead of when
+	// they are first set
+	GLint uniformCount;
+	GLint maxNameLength;
+	glGetProgramiv(_program_id, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(_program_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<GLchar> name(std::max(maxNameLength, 1));
+
+	for (GLint i = 0; i < uniformCount; i++) {
+		GLsizei length;
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(_program_id, i, name.size(), &length, &size, &type, name.data());
+
+		// members of uniform blocks have no location
+		GLint location = glGetUniformLocation(_program_id, name.data());
+
+		if (location >= 0) {
+			_uniforms.emplace(std::string(name.data(), length), Uniform(_program_id, location));
+		}
+	}
+
+	// bind the uniform blocks
+	for (const auto& block : _blocks_to_bind) {
+		GLuint index = glGetUniformBlockIndex(_program_id, block.first.c_str());
+
+		if (index == GL_INVALID_INDEX) {
+			std::cerr << "shader doesn't have uniform block " << block.first << std::endl;
+			continue;
+		}
+
+		glUniformBlockBinding(_program_id, index, block.second);
+	}
+
+	_blocks_to_bind.clear();
 }
 
 GLuint ShaderProgram::_AddShaderFromSource(GLuint type, std::string source) {
@@ -4,17 +4,16 @@
 
 #include "Shooter.h"
 
-#include "Error.h"
 #include "Level.h"
 
+LineBatch::Mesh Shooter::_arrow_meshes[4];
+bool Shooter::_is_renderer_prepared = false;
+
 Shooter::Shooter(unsigned x, unsigned y, float shootTime, float currentTime) :
-		Wall(x, y), _shoot_time(shootTime), _current_time(currentTime) {}
+		Wall(x, y, SHOOTER), _shoot_time(shootTime),
+		_last_shot_time(-currentTime), _next_shot_time(shootTime - currentTime) {}
 
 void Shooter::AddShootingDirection(int dx, int dy) {
-	if (_vao) {
-		throw showerror("Shooter renderer already initialized");
-	}
-
 	_shooting_directions.push_back({ dx, dy });
 }
 
@@ -22,104 +21,113 @@ void Shooter::SetNextAsDiamond() {
 	_next_diamond = true;
 }
 
-void Shooter::Render(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) const {
-	_PrepareRenderer();
+void Shooter::Start(float time) {
+	_last_shot_time += time;
+	_next_shot_time += time;
+}
 
-	Wall::Render(screenDimensions, cameraParams);
-	_line_shader["color"] = glm::vec4 {
-		1.0f,
-		1.0f - _current_time / _shoot_time,
-		1.0f - _current_time / _shoot_time,
-		1.0f
-	};
-
-	glBindVertexArray(_vao);
-	glDrawArrays(GL_LINES, 0, _count);
-	glBindVertexArray(0);
+bool Shooter::Wake() {
+	bool charged = _charged;
+	_charged = false;
+	return charged;
 }
 
-void Shooter::InternalUpdate(float dt, Level& level) {
-	_current_time += dt;
+float Shooter::NextShotTime() const {
+	return _next_shot_time;
+}
 
-	std::normal_distribution<float> dist(0.0f, 2.0f);
+void Shooter::SetRenderTime(float time) {
+	_render_time = time;
+}
 
-	if (_current_time > _shoot_time) {
-		_current_time = 0;
+void Shooter::Render(LineBatch& batch) const {
+	_PrepareRenderer();
 
-		int diamondIndex = -1;
-		if (_next_diamond) {
-			diamondIndex = std::uniform_int_distribution<int>(0, _shooting_directions.size() - 1)(level.RNG());
-			_next_diamond = false;
-		}
+	float charge = _charged ? 1.0f : (_render_time - _last_shot_time) / (_next_shot_time - _last_shot_time);
 
-		int idx = 0;
-		for (const auto& direction : _shooting_directions) {
-			if (diamondIndex == idx) {
-				level.SpawnDiamond(_x + direction.x,
-						_y + direction.y,
-						float(direction.x) * 0.5f + direction.y * dist(level.RNG()),
-						float(direction.y) * 0.5f + direction.x * dist(level.RNG()));
-			} else {
-				level.SpawnBlockBullet(_x + direction.x,
-						_y + direction.y,
-						float(direction.x) * 2.0f + direction.y * dist(level.RNG()),
-						float(direction.y) * 2.0f + direction.x * dist(level.RNG()));
-			}
-			idx++;
-		}
+	// the outline is drawn with the other walls
+	for (const auto& direction : _shooting_directions) {
+		batch.Add(_arrow_meshes[_DirectionIndex(direction)], {
+			{ _render_x, _render_y }, _render_rotation, { 0.5f, 0.5f }, 1.0f,
+			{ 1.0f, 1.0f - charge, 1.0f - charge, 1.0f }
+		});
 	}
 }
 
-void Shooter::_PrepareRenderer() const {
-	_PrepareShader();
-
-	if (_is_renderer_prepared) {
-		return;
+bool Shooter::Shoot(Level& level) {
+	if (IsDormant()) {
+		// stay charged, and only shoot once the shooter is active again
+		_charged = true;
+		return false;
 	}
 
-	std::vector<GLfloat> data;
+	std::normal_distribution<float> dist(0.0f, 2.0f);
+
+	int diamondIndex = -1;
+	if (_next_diamond) {
+		diamondIndex = std::uniform_int_distribution<int>(0, _shooting_directions.size() - 1)(level.RNG());
+		_next_diamond = false;
+	}
 
+	int idx = 0;
 	for (const auto& direction : _shooting_directions) {
-		std::vector<GLfloat> add;
-
-		if (direction == glm::ivec2 { 1, 0 }) {
-			add = {
-					0.95f, 0.20f, 0.60f, 0.50f,
-					0.60f, 0.50f, 0.95f, 0.80f
-			};
-		} else if (direction == glm::ivec2 { -1, 0 }) {
-			add = {
-					0.05f, 0.20f, 0.40f, 0.50f,
-					0.40f, 0.50f, 0.05f, 0.80f
-			};
-		} else if (direction == glm::ivec2 { 0, -1 }) {
-			add = {
-					0.20f, 0.95f, 0.50f, 0.60f,
-					0.50f, 0.60f, 0.80f, 0.95f
-			};
-		}else if (direction == glm::ivec2 { 0, 1 }) {
-			add = {
-					0.20f, 0.05f, 0.50f, 0.40f,
-					0.50f, 0.40f, 0.80f, 0.05f
-			};
+		if (diamondIndex == idx) {
+			level.SpawnDiamond(_x + direction.x,
+					_y + direction.y,
+					float(direction.x) * 0.5f + direction.y * dist(level.RNG()),
+					float(direction.y) * 0.5f + direction.x * dist(level.RNG()));
+		} else {
+			level.SpawnBlockBullet(_x + direction.x,
+					_y + direction.y,
+					float(direction.x) * 2.0f + direction.y * dist(level.RNG()),
+					float(direction.y) * 2.0f + direction.x * dist(level.RNG()));
 		}
-
-		std::copy(add.begin(), add.end(), std::back_inserter(data));
+		idx++;
 	}
 
-	_count = data.size() / 2;
+	// the budget may slow down the next shot
+	_last_shot_time = level.Time();
+	_next_shot_time = _last_shot_time + _shoot_time / level.FireRate();
+	return true;
+}
 
-	_vao = GL::GenVertexArray();
-	_vbo = GL::GenBuffer();
+void Shooter::_PrepareRenderer() {
+	if (_is_renderer_prepared) {
+		return;
+	}
+
+	_arrow_meshes[0] = LineBatch::CreateMesh(GL_LINES, {
+			0.95f, 0.20f, 0.60f, 0.50f,
+			0.60f, 0.50f, 0.95f, 0.80f
+	});
 
-	glBindVertexArray(_vao);
-	glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(GLfloat), data.data(), GL_STATIC_DRAW);
+	_arrow_meshes[1] = LineBatch::CreateMesh(GL_LINES, {
+			0.05f, 0.20f, 0.40f, 0.50f,
+			0.40f, 0.50f, 0.05f, 0.80f
+	});
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void *) 0);
+	_arrow_meshes[2] = LineBatch::CreateMesh(GL_LINES, {
+			0.20f, 0.95f, 0.50f, 0.60f,
+			0.50f, 0.60f, 0.80f, 0.95f
+	});
 
-	glBindVertexArray(0);
+	_arrow_meshes[3] = LineBatch::CreateMesh(GL_LINES, {
+			0.20f, 0.05f, 0.50f, 0.40f,
+			0.50f, 0.40f, 0.80f, 0.05f
+	});
 
 	_is_renderer_prepared = true;
 }
+
+unsigned Shooter::_DirectionIndex(const glm::ivec2& direction) {
+	// the order of the arrow meshes: right, left, up (-y), down (+y)
+	if (direction.x > 0) {
+		return 0;
+	} else if (direction.x < 0) {
+		return 1;
+	} else if (direction.y < 0) {
+		return 2;
+	} else {
+		return 3;
+	}
+}
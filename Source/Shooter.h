@@ -16,23 +16,40 @@ public:
 	void AddShootingDirection(int dx, int dy);
 	void SetNextAsDiamond();
 
-	void Render(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) const;
-
-protected:
-	void InternalUpdate(float dt, Level& level);
+	/**
+	 * Shooters only run when a shot is due, from a timer of the level.
+	 * Start() moves the first shot to the time the shooter is added,
+	 * Shoot() fires and plans the next shot. A dormant shooter doesn't
+	 * fire but stays charged, Wake() tells whether it was, so the level
+	 * can have it shoot right away.
+	 */
+	void Start(float time);
+	bool Shoot(Level& level);
+	bool Wake();
+	float NextShotTime() const;
+
+	/*
+	 * The time the charge is shown for.
+	 */
+	void SetRenderTime(float time);
+
+	void Render(LineBatch& batch) const;
 
 private:
-	void _PrepareRenderer() const;
+	static void _PrepareRenderer();
+	static unsigned _DirectionIndex(const glm::ivec2& direction);
 
 	std::vector<glm::ivec2> _shooting_directions;
 	const float _shoot_time;
-	float _current_time = 0.0f;
+	float _last_shot_time;
+	float _next_shot_time;
+	float _render_time = 0.0f;
+	bool _charged = false;
 	bool _next_diamond = false;
 
-	mutable GLhandle _vao;
-	mutable GLhandle _vbo;
-	mutable unsigned _count = 0;
-	mutable bool _is_renderer_prepared = false;
+	// one arrow mesh for each shooting direction
+	static LineBatch::Mesh _arrow_meshes[4];
+	static bool _is_renderer_prepared;
 };
 
 #endif
@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "StepScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/*
+ * The smallest extent of a shape, and the distance of its farthest point
+ * from the body origin, both in body space. The AABBs of the fixtures
+ * can't be used for this, they are grown by the movement of the body.
+ */
+bool ShapeExtent(const b2Shape *shape, float& size, float& reach) {
+	if (shape->m_type == b2Shape::e_circle) {
+		const b2CircleShape *circle = static_cast<const b2CircleShape *>(shape);
+		size = 2.0f * circle->m_radius;
+		reach = circle->m_p.Length() + circle->m_radius;
+		return true;
+	}
+
+	if (shape->m_type == b2Shape::e_polygon) {
+		const b2PolygonShape *polygon = static_cast<const b2PolygonShape *>(shape);
+		b2Vec2 lower(INFINITY, INFINITY);
+		b2Vec2 upper(-INFINITY, -INFINITY);
+		reach = 0.0f;
+
+		for (int32 i = 0; i < polygon->m_count; i++) {
+			const b2Vec2& v = polygon->m_vertices[i];
+			lower.Set(std::min(lower.x, v.x), std::min(lower.y, v.y));
+			upper.Set(std::max(upper.x, v.x), std::max(upper.y, v.y));
+			reach = std::max(reach, v.Length());
+		}
+
+		size = std::min(upper.x - lower.x, upper.y - lower.y);
+		return polygon->m_count > 0;
+	}
+
+	// the bodies of the game have no edges or chains
+	return false;
+}
+
+}
+
+void StepScheduler::SetSubstepBounds(unsigned minSubsteps, unsigned maxSubsteps) {
+	_min_substeps = std::max(minSubsteps, 1u);
+	_max_substeps = std::max(maxSubsteps, _min_substeps);
+}
+
+void StepScheduler::SetIterationBounds(int minVelocity, int maxVelocity, int minPosition, int maxPosition) {
+	_min_velocity_iterations = minVelocity;
+	_max_velocity_iterations = std::max(maxVelocity, minVelocity);
+	_min_position_iterations = minPosition;
+	_max_position_iterations = std::max(maxPosition, minPosition);
+}
+
+void StepScheduler::SetMaxTravel(float fraction) {
+	_max_travel = fraction;
+}
+
+StepScheduler::Schedule StepScheduler::Plan(const b2World& world, float dt) const {
+	float maxSpeed = 0.0f;
+	float minSize = INFINITY;
+
+	for (const b2Body *body = world.GetBodyList(); body; body = body->GetNext()) {
+		if (body->GetType() != b2_dynamicBody || !body->IsActive() || !body->IsAwake()) {
+			continue;
+		}
+
+		for (const b2Fixture *fixture = body->GetFixtureList(); fixture; fixture = fixture->GetNext()) {
+			float size;
+			float reach;
+
+			if (!ShapeExtent(fixture->GetShape(), size, reach)) {
+				continue;
+			}
+
+			// rotating bodies move fastest at their far edge
+			float speed = body->GetLinearVelocity().Length()
+					+ std::abs(body->GetAngularVelocity()) * reach;
+
+			maxSpeed = std::max(maxSpeed, speed);
+			minSize = std::min(minSize, size);
+		}
+	}
+
+	unsigned substeps = _min_substeps;
+
+	if (maxSpeed > 0.0f) {
+		float needed = std::ceil(maxSpeed * dt / (_max_travel * minSize));
+		substeps = unsigned(std::min(std::max(needed, float(_min_substeps)), float(_max_substeps)));
+	}
+
+	// the more substeps are needed, the more the solver has to iterate
+	float t = _max_substeps == _min_substeps ? 1.0f : float(substeps - _min_substeps) / (_max_substeps - _min_substeps);
+
+	Schedule schedule;
+	schedule.substeps = substeps;
+	schedule.velocity_iterations = int(std::round(_min_velocity_iterations + t * (_max_velocity_iterations - _min_velocity_iterations)));
+	schedule.position_iterations = int(std::round(_min_position_iterations + t * (_max_position_iterations - _min_position_iterations)));
+	return schedule;
+}
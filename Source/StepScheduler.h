@@ -0,0 +1,49 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef STEPSCHEDULER_H_
+#define STEPSCHEDULER_H_
+
+#include <Box2D/Box2D.h>
+
+/**
+ * Picks the number of physics substeps and solver iterations for a tick.
+ * The fastest dynamic body may travel only a fraction of the smallest
+ * dynamic collider per substep, so calm ticks take a single cheap step and
+ * fast ticks are split up until they are stable again.
+ */
+class StepScheduler {
+
+public:
+	struct Schedule {
+		unsigned substeps;
+		int velocity_iterations;
+		int position_iterations;
+	};
+
+	void SetSubstepBounds(unsigned minSubsteps, unsigned maxSubsteps);
+	void SetIterationBounds(int minVelocity, int maxVelocity, int minPosition, int maxPosition);
+
+	/**
+	 * Sets the largest part of the smallest collider that a body may travel
+	 * during one substep.
+	 */
+	void SetMaxTravel(float fraction);
+
+	Schedule Plan(const b2World& world, float dt) const;
+
+private:
+	unsigned _min_substeps = 1;
+	unsigned _max_substeps = 8;
+
+	int _min_velocity_iterations = 4;
+	int _max_velocity_iterations = 10;
+	int _min_position_iterations = 2;
+	int _max_position_iterations = 10;
+
+	float _max_travel = 0.25f;
+
+};
+
+#endif
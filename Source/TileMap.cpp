@@ -0,0 +1,322 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "TileMap.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "Entity.h"
+
+constexpr unsigned TileMap::_no_region;
+
+void TileMap::Resize(unsigned width, unsigned height) {
+	if (width == _width && height == _height) {
+		return;
+	}
+
+	std::vector<EntityHandle> tiles(width * height);
+
+	for (unsigned j = 0; j < std::min(_height, height); j++) {
+		std::copy(_tiles.begin() + j * _width, _tiles.begin() + j * _width + std::min(_width, width), tiles.begin() + j * width);
+	}
+
+	_tiles.swap(tiles);
+	_width = width;
+	_height = height;
+	_version++;
+
+	// the tile indices change, so every region is rebuilt
+	for (unsigned region = 0; region < _regions.size(); region++) {
+		_ClearRegion(region);
+	}
+
+	_regions.clear();
+	_free_regions.clear();
+	_tile_regions.assign(_width * _height, _no_region);
+	_traced_sides.assign(_width * _height, 0);
+
+	_chunks_x = (_width + chunk_size - 1) / chunk_size;
+	_chunks_y = (_height + chunk_size - 1) / chunk_size;
+	_chunk_versions.assign(_chunks_x * _chunks_y, _version);
+	_is_chunk_dirty.assign(_chunks_x * _chunks_y, true);
+	_dirty_chunks.resize(_chunks_x * _chunks_y);
+
+	for (unsigned chunk = 0; chunk < _dirty_chunks.size(); chunk++) {
+		_dirty_chunks[chunk] = chunk;
+	}
+}
+
+void TileMap::Set(unsigned x, unsigned y, const EntityHandle& handle) {
+	if (x >= _width || y >= _height) {
+		Resize(
+				x < _width ? _width : std::max(x + 1, _width * 2),
+				y < _height ? _height : std::max(y + 1, _height * 2));
+	}
+
+	if (_tiles[y * _width + x] == handle) {
+		return;
+	}
+
+	_tiles[y * _width + x] = handle;
+	_version++;
+
+	unsigned chunk = (y / chunk_size) * _chunks_x + x / chunk_size;
+	_chunk_versions[chunk] = _version;
+
+	if (!_is_chunk_dirty[chunk]) {
+		_is_chunk_dirty[chunk] = true;
+		_dirty_chunks.push_back(chunk);
+	}
+}
+
+EntityHandle TileMap::At(int x, int y) const {
+	if (x < 0 || y < 0 || unsigned(x) >= _width || unsigned(y) >= _height) {
+		return EntityHandle();
+	}
+
+	return _tiles[y * _width + x];
+}
+
+EntityHandle TileMap::At(const b2Vec2& position) const {
+	return At(int(std::round(position.x)), int(std::round(position.y)));
+}
+
+bool TileMap::IsSolid(int x, int y) const {
+	return (bool) At(x, y);
+}
+
+unsigned TileMap::Width() const {
+	return _width;
+}
+
+unsigned TileMap::Height() const {
+	return _height;
+}
+
+uint64_t TileMap::Version() const {
+	return _version;
+}
+
+unsigned TileMap::ChunkCount() const {
+	return _chunks_x * _chunks_y;
+}
+
+uint64_t TileMap::ChunkVersion(unsigned chunk) const {
+	return _chunk_versions[chunk];
+}
+
+void TileMap::ChunkBounds(unsigned chunk, unsigned& x0, unsigned& y0, unsigned& x1, unsigned& y1) const {
+	x0 = (chunk % _chunks_x) * chunk_size;
+	y0 = (chunk / _chunks_x) * chunk_size;
+	x1 = std::min(x0 + chunk_size, _width);
+	y1 = std::min(y0 + chunk_size, _height);
+}
+
+void TileMap::UpdateColliders(std::shared_ptr<b2World> world) {
+	if (!_b2_body) {
+		b2BodyDef bodyDef;
+		bodyDef.type = b2_staticBody;
+
+		_b2_body = std::shared_ptr<b2Body>(world->CreateBody(&bodyDef), [world](b2Body *body) {
+			world->DestroyBody(body);
+		});
+	}
+
+	// clear the regions in and next to the changed chunks, their tiles and
+	// the solid tiles of the chunks are where the new regions grow from
+	_seeds.clear();
+
+	for (unsigned chunk : _dirty_chunks) {
+		unsigned x0, y0, x1, y1;
+		ChunkBounds(chunk, x0, y0, x1, y1);
+
+		for (unsigned y = y0 > 0 ? y0 - 1 : 0; y < std::min(y1 + 1, _height); y++) {
+			for (unsigned x = x0 > 0 ? x0 - 1 : 0; x < std::min(x1 + 1, _width); x++) {
+				unsigned tile = y * _width + x;
+
+				if (_tile_regions[tile] != _no_region) {
+					_ClearRegion(_tile_regions[tile]);
+				}
+
+				_seeds.push_back(tile);
+			}
+		}
+
+		_is_chunk_dirty[chunk] = false;
+	}
+
+	for (unsigned tile : _seeds) {
+		if (_tiles[tile] && _tile_regions[tile] == _no_region) {
+			_BuildRegion(tile);
+		}
+	}
+
+	_dirty_chunks.clear();
+}
+
+bool TileMap::IsCollider(const b2Fixture *fixture) const {
+	return _b2_body && fixture->GetBody() == _b2_body.get();
+}
+
+unsigned TileMap::ColliderCount() const {
+	return _collider_count;
+}
+
+namespace {
+
+// per side of a tile (top, right, bottom, left), the direction in which its
+// edge is followed with the tile on the right, and the corner it starts at
+const int side_dx[4] = { 1, 0, -1, 0 };
+const int side_dy[4] = { 0, 1, 0, -1 };
+const int side_start_x[4] = { 0, 1, 1, 0 };
+const int side_start_y[4] = { 0, 0, 1, 1 };
+
+// the inset of the outer edges, like the edges of a single tile
+const float inset = 0.05f;
+
+}
+
+void TileMap::_BuildRegion(unsigned seed) {
+	unsigned region;
+
+	if (!_free_regions.empty()) {
+		region = _free_regions.back();
+		_free_regions.pop_back();
+	} else {
+		region = _regions.size();
+		_regions.emplace_back();
+	}
+
+	// flood fill the tiles connected by a side
+	std::vector<unsigned>& tiles = _regions[region].tiles;
+	tiles.push_back(seed);
+	_tile_regions[seed] = region;
+
+	for (size_t k = 0; k < tiles.size(); k++) {
+		int x = tiles[k] % _width;
+		int y = tiles[k] / _width;
+
+		for (unsigned side = 0; side < 4; side++) {
+			int nx = x + side_dy[side];
+			int ny = y - side_dx[side];
+
+			if (IsSolid(nx, ny) && _tile_regions[ny * _width + nx] == _no_region) {
+				_tile_regions[ny * _width + nx] = region;
+				tiles.push_back(ny * _width + nx);
+			}
+		}
+	}
+
+	// a loop along every boundary, the outline and the holes
+	b2Filter filter = Entity::CollisionFilter(Entity::WALL);
+
+	for (unsigned tile : tiles) {
+		int x = tile % _width;
+		int y = tile / _width;
+
+		for (unsigned side = 0; side < 4; side++) {
+			if ((_traced_sides[tile] & (1 << side)) || _IsInRegion(x + side_dy[side], y - side_dx[side], region)) {
+				continue;
+			}
+
+			_TraceLoop(region, tile, side);
+
+#ifndef NDEBUG
+			// a straight run of tiles, also across chunks, is a single edge,
+			// so the boundary turns by a right angle at every vertex
+			for (size_t i = 0; i < _loop.size(); i++) {
+				const b2Vec2& previous = _loop[(i + _loop.size() - 1) % _loop.size()];
+				const b2Vec2& next = _loop[(i + 1) % _loop.size()];
+				assert(std::abs(b2Dot(_loop[i] - previous, next - _loop[i])) < 1e-4f);
+			}
+#endif
+
+			b2ChainShape shape;
+			shape.CreateLoop(_loop.data(), _loop.size());
+
+			b2FixtureDef fixtureDef;
+			fixtureDef.shape = &shape;
+			fixtureDef.friction = 0.0f;
+			fixtureDef.filter = filter;
+			fixtureDef.userData = _tiles[seed].ToUserData();
+
+			_regions[region].fixtures.push_back(_b2_body->CreateFixture(&fixtureDef));
+			_collider_count++;
+		}
+	}
+
+	for (unsigned tile : tiles) {
+		_traced_sides[tile] = 0;
+	}
+}
+
+void TileMap::_ClearRegion(unsigned region) {
+	// destroying a fixture ends its contacts, so these are still reported
+	for (b2Fixture *fixture : _regions[region].fixtures) {
+		_b2_body->DestroyFixture(fixture);
+	}
+
+	for (unsigned tile : _regions[region].tiles) {
+		_tile_regions[tile] = _no_region;
+		_seeds.push_back(tile);
+	}
+
+	_collider_count -= _regions[region].fixtures.size();
+	_regions[region].fixtures.clear();
+	_regions[region].tiles.clear();
+	_free_regions.push_back(region);
+}
+
+void TileMap::_TraceLoop(unsigned region, unsigned tile, unsigned side) {
+	_loop.clear();
+
+	const int startX = tile % _width + side_start_x[side];
+	const int startY = tile / _width + side_start_y[side];
+	const unsigned startSide = side;
+	int x = startX;
+	int y = startY;
+
+	do {
+		// the tile whose side starts at the corner
+		int tx = x - side_start_x[side];
+		int ty = y - side_start_y[side];
+		_traced_sides[ty * _width + tx] |= 1 << side;
+
+		x += side_dx[side];
+		y += side_dy[side];
+
+		// where two tiles touch only at their corners, turn around the tile
+		// just followed first, so each region keeps to its own tiles
+		unsigned next = side;
+
+		for (unsigned turn : { 1u, 0u, 3u }) {
+			unsigned candidate = (side + turn) % 4;
+			int cx = x - side_start_x[candidate];
+			int cy = y - side_start_y[candidate];
+
+			if (_IsInRegion(cx, cy, region) && !_IsInRegion(cx + side_dy[candidate], cy - side_dx[candidate], region)) {
+				next = candidate;
+				break;
+			}
+		}
+
+		// only the corners where the boundary turns become vertices, moved
+		// inwards along both edges
+		if (next != side) {
+			_loop.push_back({
+				x - 0.5f + inset * (-side_dy[side] - side_dy[next]),
+				y - 0.5f + inset * (side_dx[side] + side_dx[next])
+			});
+		}
+
+		side = next;
+	} while (x != startX || y != startY || side != startSide);
+}
+
+bool TileMap::_IsInRegion(int x, int y, unsigned region) const {
+	return x >= 0 && y >= 0 && unsigned(x) < _width && unsigned(y) < _height
+			&& _tile_regions[y * _width + x] == region;
+}
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef TILEMAP_H_
+#define TILEMAP_H_
+
+#include <memory>
+#include <vector>
+
+#include <Box2D/Box2D.h>
+
+#include "EntityHandle.h"
+
+/**
+ * The grid of solid tiles (walls and shooters) of a level. Tile (x, y) is
+ * centered at (x, y). Each solid tile keeps a handle to its own entity,
+ * but the colliders of all tiles are chain loops around each connected
+ * region of tiles, on one static body, so there are no seams between tiles
+ * to catch on. The grid is split into square chunks to track changes, and
+ * only the regions around changed chunks are rebuilt.
+ */
+class TileMap {
+
+public:
+	static constexpr unsigned chunk_size = 16;
+
+	TileMap() = default;
+
+	// the colliders are destroyed with the tile map
+	TileMap(const TileMap&) = delete;
+	TileMap& operator=(const TileMap&) = delete;
+
+	/**
+	 * Resizes the grid, keeping the tiles that still fit. Every chunk is
+	 * rebuilt, so the grid should be sized once before it is filled.
+	 */
+	void Resize(unsigned width, unsigned height);
+
+	/**
+	 * Sets the entity of a tile. Pass an invalid handle to clear the tile.
+	 * A tile outside the grid at least doubles the size along that axis.
+	 * The colliders are not updated until UpdateColliders() is called.
+	 */
+	void Set(unsigned x, unsigned y, const EntityHandle& handle);
+
+	/**
+	 * The handle of the entity at the tile, which is invalid when the tile
+	 * is empty or outside the grid.
+	 */
+	EntityHandle At(int x, int y) const;
+	EntityHandle At(const b2Vec2& position) const;
+	bool IsSolid(int x, int y) const;
+
+	unsigned Width() const;
+	unsigned Height() const;
+
+	/*
+	 * Changes whenever a tile changes.
+	 */
+	uint64_t Version() const;
+
+	/*
+	 * The chunks, with the version at which a tile of each last changed,
+	 * so a reader can find the chunks that changed since it last looked.
+	 * The range of tiles of a chunk is [x0, x1) by [y0, y1).
+	 */
+	unsigned ChunkCount() const;
+	uint64_t ChunkVersion(unsigned chunk) const;
+	void ChunkBounds(unsigned chunk, unsigned& x0, unsigned& y0, unsigned& x1, unsigned& y1) const;
+
+	/**
+	 * Rebuilds the colliders of every region in or next to a chunk that
+	 * changed since the last call. Each boundary of a region becomes a
+	 * chain loop, inset like the edges of a single tile, with vertices only
+	 * where it turns. The user data of each fixture is the handle of a tile
+	 * of its region. Must not be called during a physics step.
+	 */
+	void UpdateColliders(std::shared_ptr<b2World> world);
+
+	bool IsCollider(const b2Fixture *fixture) const;
+	unsigned ColliderCount() const;
+
+private:
+	struct _Region {
+		std::vector<unsigned> tiles;
+		std::vector<b2Fixture *> fixtures;
+	};
+
+	static constexpr unsigned _no_region = ~0u;
+
+	/*
+	 * Creates the region of all tiles connected to the seed, and its
+	 * colliders.
+	 */
+	void _BuildRegion(unsigned seed);
+
+	/*
+	 * Destroys the colliders of the region, and adds its tiles to _seeds.
+	 */
+	void _ClearRegion(unsigned region);
+
+	/*
+	 * Follows the boundary of the region from the side of the tile, with the
+	 * region on the right, until it returns there, and stores the inset
+	 * corners in _loop.
+	 */
+	void _TraceLoop(unsigned region, unsigned tile, unsigned side);
+	bool _IsInRegion(int x, int y, unsigned region) const;
+
+	unsigned _width = 0;
+	unsigned _height = 0;
+	std::vector<EntityHandle> _tiles;
+	uint64_t _version = 0;
+
+	// per chunk, row by row
+	unsigned _chunks_x = 0;
+	unsigned _chunks_y = 0;
+	std::vector<uint64_t> _chunk_versions;
+	std::vector<unsigned> _dirty_chunks;
+	std::vector<bool> _is_chunk_dirty;
+
+	// the region of each tile, and the sides of each tile already traced
+	std::vector<unsigned> _tile_regions;
+	std::vector<uint8_t> _traced_sides;
+	std::vector<_Region> _regions;
+	std::vector<unsigned> _free_regions;
+
+	// reused by UpdateColliders
+	std::vector<unsigned> _seeds;
+	std::vector<b2Vec2> _loop;
+
+	std::shared_ptr<b2Body> _b2_body;
+	unsigned _collider_count = 0;
+
+};
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "TileRenderer.h"
+
+#include "FrameUniforms.h"
+
+ShaderProgram TileRenderer::_shader;
+bool TileRenderer::_is_shader_prepared = false;
+
+void TileRenderer::Render(const TileMap& tiles, RenderQueue& queue) {
+	_PrepareShader();
+
+	if (!_vao) {
+		// the quad is generated from the vertex ids, but a VAO still has
+		// to be bound to draw
+		_vao = GL::GenVertexArray();
+		_texture = GL::GenTexture();
+	}
+
+	// an empty texture can't be created, and there is nothing to draw
+	if (tiles.Width() == 0 || tiles.Height() == 0) {
+		return;
+	}
+
+	_Upload(tiles);
+
+	queue.Submit(RenderQueue::WALLS, { &_shader, (GLuint) _vao, (GLuint) _texture, GL_TRIANGLE_STRIP, 4, 0, nullptr });
+}
+
+void TileRenderer::_Upload(const TileMap& tiles) {
+	if (_is_uploaded && tiles.Version() == _version) {
+		return;
+	}
+
+	GLState::BindTexture(0, (GLuint) _texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	if (!_is_uploaded || tiles.Width() != _width || tiles.Height() != _height) {
+		_width = tiles.Width();
+		_height = tiles.Height();
+		_Read(tiles, 0, 0, _width, _height);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, _width, _height, 0, GL_RED, GL_UNSIGNED_BYTE, _solid.data());
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	} else {
+		for (unsigned chunk = 0; chunk < tiles.ChunkCount(); chunk++) {
+			if (tiles.ChunkVersion(chunk) <= _version) {
+				continue;
+			}
+
+			unsigned x0, y0, x1, y1;
+			tiles.ChunkBounds(chunk, x0, y0, x1, y1);
+			_Read(tiles, x0, y0, x1, y1);
+
+			glTexSubImage2D(GL_TEXTURE_2D, 0, x0, y0, x1 - x0, y1 - y0, GL_RED, GL_UNSIGNED_BYTE, _solid.data());
+		}
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	_version = tiles.Version();
+	_is_uploaded = true;
+}
+
+void TileRenderer::_Read(const TileMap& tiles, unsigned x0, unsigned y0, unsigned x1, unsigned y1) {
+	_solid.resize((x1 - x0) * (y1 - y0));
+
+	for (unsigned y = y0; y < y1; y++) {
+		for (unsigned x = x0; x < x1; x++) {
+			_solid[(y - y0) * (x1 - x0) + x - x0] = tiles.IsSolid(x, y) ? 255 : 0;
+		}
+	}
+}
+
+void TileRenderer::_PrepareShader() {
+	if (_is_shader_prepared) {
+		return;
+	}
+
+	_shader.AddShaderFromFile(GL_VERTEX_SHADER, "Resources/tiles.vert.glsl");
+	_shader.AddShaderFromFile(GL_FRAGMENT_SHADER, "Resources/tiles.frag.glsl");
+	FrameUniforms::AddTo(_shader);
+	_shader.Link();
+
+	// these never change
+	_shader.Handle("color") = glm::vec4 { 1.0f, 1.0f, 1.0f, 1.0f };
+	_shader.Handle("tiles") = (GLint) 0;
+
+	_is_shader_prepared = true;
+}
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef TILERENDERER_H_
+#define TILERENDERER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "GL.h"
+#include "RenderQueue.h"
+#include "ShaderProgram.h"
+#include "TileMap.h"
+
+/**
+ * Draws the outlines of all solid tiles of a TileMap in one pass. The grid
+ * is kept in a texture with one texel per tile, and a quad covering the
+ * screen draws the outline of each solid tile in its fragment shader, so
+ * the cost depends on the screen size instead of on the number of walls.
+ */
+class TileRenderer {
+
+public:
+	/**
+	 * Uploads the tiles and submits the command to draw them, with the
+	 * current FrameUniforms.
+	 */
+	void Render(const TileMap& tiles, RenderQueue& queue);
+
+private:
+	/*
+	 * Uploads the chunks that changed since the last upload, or the whole
+	 * grid when its size changed.
+	 */
+	void _Upload(const TileMap& tiles);
+
+	/*
+	 * Reads the solid tiles of the range into _solid, row by row.
+	 */
+	void _Read(const TileMap& tiles, unsigned x0, unsigned y0, unsigned x1, unsigned y1);
+
+	GLhandle _texture;
+	GLhandle _vao;
+	unsigned _width = 0;
+	unsigned _height = 0;
+	std::vector<uint8_t> _solid; // scratch
+	uint64_t _version = 0;
+	bool _is_uploaded = false;
+
+	static void _PrepareShader();
+
+	static ShaderProgram _shader;
+	static bool _is_shader_prepared;
+
+};
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "TimerWheel.h"
+
+void TimerWheel::Schedule(uint64_t tick, const EntityHandle& entity, uint32_t kind) {
+	_Insert({ tick > _now ? tick : _now + 1, entity, kind });
+	_size++;
+}
+
+std::vector<TimerWheel::Timer> TimerWheel::TakeAll() {
+	std::vector<Timer> timers;
+	timers.reserve(_size);
+
+	for (auto& wheel : _slots) {
+		for (std::vector<Timer>& slot : wheel) {
+			timers.insert(timers.end(), slot.begin(), slot.end());
+			slot.clear();
+		}
+	}
+
+	_size = 0;
+	return timers;
+}
+
+uint64_t TimerWheel::Now() const {
+	return _now;
+}
+
+size_t TimerWheel::Size() const {
+	return _size;
+}
+
+void TimerWheel::_Insert(const Timer& timer) {
+	uint64_t delta = timer.due - _now;
+
+	for (unsigned wheel = 0; wheel < wheel_count; wheel++) {
+		if (delta < (uint64_t(1) << (slot_bits * (wheel + 1))) || wheel + 1 == wheel_count) {
+			// timers beyond the last wheel wait in its farthest slot, and
+			// are inserted again once that slot cascades
+			uint64_t due = wheel + 1 == wheel_count && delta >= (uint64_t(1) << (slot_bits * wheel_count))
+					? _now + (uint64_t(1) << (slot_bits * wheel_count)) - 1
+					: timer.due;
+
+			_slots[wheel][(due >> (slot_bits * wheel)) & (slot_count - 1)].push_back(timer);
+			return;
+		}
+	}
+}
+
+void TimerWheel::_Cascade(unsigned wheel) {
+	if (wheel >= wheel_count) {
+		return;
+	}
+
+	unsigned slot = (_now >> (slot_bits * wheel)) & (slot_count - 1);
+
+	// the coarser wheel turns first, its timers may land in this slot
+	if (slot == 0) {
+		_Cascade(wheel + 1);
+	}
+
+	std::vector<Timer> timers;
+	timers.swap(_slots[wheel][slot]);
+
+	for (const Timer& timer : timers) {
+		_Insert(timer);
+	}
+}
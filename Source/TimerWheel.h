@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "EntityHandle.h"
+
+/**
+ * A hierarchical timer wheel, counting in ticks. Timers due within 64
+ * ticks sit in the slots of the first wheel, later ones in coarser wheels
+ * that cascade down as time passes. Scheduling is constant time, and
+ * advancing only touches the slots that come due, however many timers are
+ * waiting.
+ */
+class TimerWheel {
+
+public:
+	static constexpr unsigned slot_bits = 6;
+	static constexpr unsigned slot_count = 1 << slot_bits;
+	static constexpr unsigned wheel_count = 4;
+
+	struct Timer {
+		uint64_t due;
+		EntityHandle entity;
+		uint32_t kind;
+	};
+
+	/**
+	 * Schedules a timer at the given tick. Timers that are already due
+	 * fire at the next tick.
+	 */
+	void Schedule(uint64_t tick, const EntityHandle& entity, uint32_t kind);
+
+	/**
+	 * Advances to the given tick, calling function(const Timer&) for all
+	 * timers that come due, in order of their tick. Timers scheduled from
+	 * the function fire in the same call if they are due by then.
+	 */
+	template<typename Function>
+	void Advance(uint64_t tick, Function function);
+
+	/**
+	 * Removes all pending timers and returns them, for instance to schedule
+	 * them again when the length of a tick changes.
+	 */
+	std::vector<Timer> TakeAll();
+
+	uint64_t Now() const;
+	size_t Size() const;
+
+private:
+	void _Insert(const Timer& timer);
+	void _Cascade(unsigned wheel);
+
+	uint64_t _now = 0;
+	size_t _size = 0;
+
+	std::vector<Timer> _slots[wheel_count][slot_count];
+	std::vector<Timer> _due;
+
+};
+
+template<typename Function>
+void TimerWheel::Advance(uint64_t tick, Function function) {
+	while (_now < tick) {
+		_now++;
+
+		if ((_now & (slot_count - 1)) == 0) {
+			_Cascade(1);
+		}
+
+		// timers scheduled while firing never land in this slot again
+		_due.swap(_slots[0][_now & (slot_count - 1)]);
+		_size -= _due.size();
+
+		for (const Timer& timer : _due) {
+			function(timer);
+		}
+
+		_due.clear();
+	}
+}
+
+#endif
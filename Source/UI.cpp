@@ -11,98 +11,55 @@ GLhandle UI::_quad_vbo;
 GLhandle UI::_line_vao;
 GLhandle UI::_line_vbo;
 ShaderProgram UI::_shader;
+Uniform UI::_screen_dimensions_uniform;
+Uniform UI::_params_uniform;
+Uniform UI::_color_uniform;
+Uniform UI::_has_texture_uniform;
 std::vector<GLhandle> UI::_font;
 GLhandle UI::_fontgo;
 GLhandle UI::_fontpress;
 GLhandle UI::_fontmain;
 bool UI::_is_renderer_prepared = false;
 
-void UI::_InitializeScreenDimensions(const glm::ivec2& screenDimensions) {
+void UI::_InitializeScreenDimensions(const glm::ivec2& screenDimensions, RenderQueue& queue) {
 	_PrepareRenderer();
 
-	_shader.Use();
-	_shader["screenDimensions"] = (glm::vec2) screenDimensions;
-
 	_screen_dimensions = screenDimensions;
+	_queue = &queue;
 }
 
 void UI::_SetColor(const glm::vec4& color) {
-	_shader.Use();
-	_shader["color"] = color;
-
 	_color = color;
 }
 
-void UI::_DrawQuad(float x, float y, float width, float height) {
+void UI::_DrawQuad(float x, float y, float width, float height, GLuint texture) {
 	_PrepareRenderer();
 
-	_shader.Use();
-	_shader["params"] = glm::vec4 { x, y, width, height };
-
-	glBindVertexArray(_quad_vao);
-	glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-	glBindVertexArray(0);
+	_Submit((GLuint) _quad_vao, texture, GL_TRIANGLE_FAN, 4, { x, y, width, height });
 }
 
 void UI::_DrawLine(float x1, float y1, float x2, float y2) {
 	_PrepareRenderer();
 
-	_shader.Use();
-	_shader["params"] = glm::vec4 { x1, y1, x2 - x1, y2 - y1 };
-
-	glBindVertexArray(_line_vao);
-	glDrawArrays(GL_LINES, 0, 2);
-	glBindVertexArray(0);
+	_Submit((GLuint) _line_vao, 0, GL_LINES, 2, { x1, y1, x2 - x1, y2 - y1 });
 }
 
 void UI::_DrawText(const std::string& text, float x, float y, float height) {
 	if (text == std::string("main")) {
-		_shader.Use();
-		_shader["hasTexture"] = (GLint) 1;
-
-		glBindTexture(GL_TEXTURE_2D, (GLuint) _fontmain);
-
-		_DrawQuad(x, y, height, height);
-
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		_shader["hasTexture"] = (GLint) 0;
+		_DrawQuad(x, y, height, height, _fontmain);
 		return;
 	} else if (text == std::string("go")) {
-		_shader.Use();
-		_shader["hasTexture"] = (GLint) 1;
-
-		glBindTexture(GL_TEXTURE_2D, (GLuint) _fontgo);
-
-		_DrawQuad(x, y, height * 6.16f, height);
-
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		_shader["hasTexture"] = (GLint) 0;
+		_DrawQuad(x, y, height * 6.16f, height, _fontgo);
 		return;
 	} else if (text == std::string("press")) {
-		_shader.Use();
-		_shader["hasTexture"] = (GLint) 1;
-
-		glBindTexture(GL_TEXTURE_2D, (GLuint) _fontpress);
-
-		_DrawQuad(x, y, height * 10.63f, height);
-
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		_shader["hasTexture"] = (GLint) 0;
+		_DrawQuad(x, y, height * 10.63f, height, _fontpress);
 		return;
 	}
 
-	_shader.Use();
-	_shader["hasTexture"] = (GLint) 1;
-
 	for (char c : text) {
 		_DrawCharacter(c, x, y, height);
 		x += height * 0.8f;
 	}
-
-	_shader["hasTexture"] = (GLint) 0;
 }
 
 void UI::_DrawCharacter(char character, float x, float y, float height) {
@@ -112,11 +69,23 @@ void UI::_DrawCharacter(char character, float x, float y, float height) {
 		return;
 	}
 
-	glBindTexture(GL_TEXTURE_2D, (GLuint) _font[character - '0']);
+	_DrawQuad(x, y, height * 0.75f, height, _font[character - '0']);
+}
 
-	_DrawQuad(x, y, height * 0.75f, height);
+void UI::_Submit(GLuint vao, GLuint texture, GLenum mode, GLsizei count, const glm::vec4& params) {
+	// the uniforms are set when the command is drawn
+	_queue->Submit(RenderQueue::UI, { &_shader, vao, texture, mode, count, 0, _ApplyUniforms }, {
+		params,
+		_color,
+		{ _screen_dimensions.x, _screen_dimensions.y, texture ? 1.0f : 0.0f, 0.0f }
+	});
+}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+void UI::_ApplyUniforms(const glm::vec4 *uniforms) {
+	_params_uniform = uniforms[0];
+	_color_uniform = uniforms[1];
+	_screen_dimensions_uniform = glm::vec2 { uniforms[2].x, uniforms[2].y };
+	_has_texture_uniform = (GLint) (uniforms[2].z != 0.0f);
 }
 
 void UI::_PrepareRenderer() {
@@ -132,6 +101,11 @@ void UI::_PrepareRenderer() {
 	_shader.AddShaderFromFile(GL_FRAGMENT_SHADER, "Resources/ui.frag.glsl");
 	_shader.Link();
 
+	_screen_dimensions_uniform = _shader.Handle("screenDimensions");
+	_params_uniform = _shader.Handle("params");
+	_color_uniform = _shader.Handle("color");
+	_has_texture_uniform = _shader.Handle("hasTexture");
+
 	_is_renderer_prepared = true;
 }
 
@@ -146,14 +120,14 @@ void UI::_PrepareQuad() {
 	_quad_vao = GL::GenVertexArray();
 	_quad_vbo = GL::GenBuffer();
 
-	glBindVertexArray(_quad_vao);
+	GLState::BindVertexArray(_quad_vao);
 	glBindBuffer(GL_ARRAY_BUFFER, _quad_vbo);
 	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(GLfloat), data.data(), GL_STATIC_DRAW);
 
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void *) 0);
 
-	glBindVertexArray(0);
+	GLState::BindVertexArray(0);
 }
 
 void UI::_PrepareLine() {
@@ -165,14 +139,14 @@ void UI::_PrepareLine() {
 	_line_vao = GL::GenVertexArray();
 	_line_vbo = GL::GenBuffer();
 
-	glBindVertexArray(_line_vao);
+	GLState::BindVertexArray(_line_vao);
 	glBindBuffer(GL_ARRAY_BUFFER, _line_vbo);
 	glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(GLfloat), data.data(), GL_STATIC_DRAW);
 
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void *) 0);
 
-	glBindVertexArray(0);
+	GLState::BindVertexArray(0);
 }
 
 void UI::_PrepareTextures() {
@@ -196,7 +170,7 @@ GLhandle UI::_GetTexture(const Image& image) {
 	GLhandle texture = GL::GenTexture();
 
 	// bind the texture
-	glBindTexture(GL_TEXTURE_2D, (GLuint) texture);
+	GLState::BindTexture(0, (GLuint) texture);
 
 	// upload texture data
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.Width(), image.Height(), 0, GL_RGBA, GL_FLOAT, image.Data());
@@ -208,6 +182,6 @@ GLhandle UI::_GetTexture(const Image& image) {
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
 	// unbind the texture and return it
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::BindTexture(0, 0);
 	return texture;
 }
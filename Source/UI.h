@@ -7,6 +7,7 @@
 
 #include <string>
 
+#include "RenderQueue.h"
 #include "ShaderProgram.h"
 #include "Level.h"
 
@@ -14,21 +15,29 @@ class UI {
 
 public:
 	virtual ~UI() = default;
-	virtual void Render(const glm::ivec2& screenDimensions) = 0;
+	virtual void Render(const glm::ivec2& screenDimensions, RenderQueue& queue) = 0;
 
 protected:
-	void _InitializeScreenDimensions(const glm::ivec2& screenDimensions);
+	/*
+	 * Starts rendering, the draw functions submit their commands to the
+	 * queue.
+	 */
+	void _InitializeScreenDimensions(const glm::ivec2& screenDimensions, RenderQueue& queue);
 	void _SetColor(const glm::vec4& color);
-	void _DrawQuad(float x, float y, float width, float height);
+	void _DrawQuad(float x, float y, float width, float height, GLuint texture = 0);
 	void _DrawLine(float x1, float y1, float x2, float y2);
 	void _DrawText(const std::string& text, float x, float y, float height);
 	void _DrawCharacter(char character, float x, float y, float height);
 
 private:
+	void _Submit(GLuint vao, GLuint texture, GLenum mode, GLsizei count, const glm::vec4& params);
+
 	glm::vec2 _screen_dimensions;
 	glm::vec4 _color;
+	RenderQueue *_queue = nullptr;
 
 private:
+	static void _ApplyUniforms(const glm::vec4 *uniforms);
 	static void _PrepareRenderer();
 	static void _PrepareQuad();
 	static void _PrepareLine();
@@ -43,6 +52,12 @@ private:
 
 	static ShaderProgram _shader;
 
+	// the uniforms of the shader, resolved when it is linked
+	static Uniform _screen_dimensions_uniform;
+	static Uniform _params_uniform;
+	static Uniform _color_uniform;
+	static Uniform _has_texture_uniform;
+
 	static std::vector<GLhandle> _font;
 	static GLhandle _fontgo;
 	static GLhandle _fontpress;
@@ -0,0 +1,49 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef UNIFORMBUFFER_H_
+#define UNIFORMBUFFER_H_
+
+#include "GL.h"
+
+/**
+ * A uniform buffer object holding a T, bound to a binding point of
+ * GL_UNIFORM_BUFFER. T must follow the std140 layout of the uniform block
+ * it is used for, and programs bind that block to the same binding point
+ * with ShaderProgram::AddUniformBlock().
+ */
+template<typename T>
+class UniformBuffer {
+
+public:
+	UniformBuffer(GLuint binding) : _binding(binding) {}
+
+	/**
+	 * Replaces the contents of the buffer. Every program using the block
+	 * sees the new contents, so values shared by the whole frame only need
+	 * to be uploaded once.
+	 */
+	void Upload(const T& data) {
+		if (!_ubo) {
+			_ubo = GL::GenBuffer();
+
+			glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
+			glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+			glBindBufferBase(GL_UNIFORM_BUFFER, _binding, _ubo);
+		}
+
+		glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	GLuint Binding() const { return _binding; }
+
+private:
+	GLuint _binding;
+	GLhandle _ubo;
+
+};
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#include "VisibilityGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool VisibilityGrid::Update(const TileMap& tiles, int originX, int originY, const glm::vec2& lower, const glm::vec2& upper) {
+	int x0 = std::max(int(std::round(lower.x)), 0);
+	int y0 = std::max(int(std::round(lower.y)), 0);
+	int x1 = std::min(int(std::round(upper.x)), int(tiles.Width()) - 1);
+	int y1 = std::min(int(std::round(upper.y)), int(tiles.Height()) - 1);
+	unsigned width = unsigned(std::max(x1 - x0 + 1, 0));
+	unsigned height = unsigned(std::max(y1 - y0 + 1, 0));
+
+	if (originX == _origin_x && originY == _origin_y && tiles.Version() == _tiles_version
+			&& x0 == _x && y0 == _y && width == _width && height == _height) {
+		return false;
+	}
+
+	_x = x0;
+	_y = y0;
+	_width = width;
+	_height = height;
+	_origin_x = originX;
+	_origin_y = originY;
+	_tiles_version = tiles.Version();
+	_visible.assign(_width * _height, 0);
+
+	glm::vec2 origin { float(originX), float(originY) };
+
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			if (!tiles.IsSolid(x, y) && _HasLineOfSight(tiles, origin, x, y)) {
+				_visible[(y - y0) * _width + (x - x0)] = 1;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool VisibilityGrid::IsVisible(float x, float y) const {
+	int i = int(std::round(x)) - _x;
+	int j = int(std::round(y)) - _y;
+
+	if (i < 0 || j < 0 || unsigned(i) >= _width || unsigned(j) >= _height) {
+		return false;
+	}
+
+	return _visible[j * _width + i];
+}
+
+bool VisibilityGrid::_HasLineOfSight(const TileMap& tiles, const glm::vec2& origin, int targetX, int targetY) {
+	// walk the tiles along the line, tile (x, y) spans x - 0.5 to x + 0.5
+	int x = int(std::round(origin.x));
+	int y = int(std::round(origin.y));
+
+	float dx = targetX - origin.x;
+	float dy = targetY - origin.y;
+	int stepX = dx > 0 ? 1 : -1;
+	int stepY = dy > 0 ? 1 : -1;
+
+	float deltaX = dx != 0.0f ? std::abs(1.0f / dx) : INFINITY;
+	float deltaY = dy != 0.0f ? std::abs(1.0f / dy) : INFINITY;
+	float nextX = dx != 0.0f ? (x + 0.5f * stepX - origin.x) / dx : INFINITY;
+	float nextY = dy != 0.0f ? (y + 0.5f * stepY - origin.y) / dy : INFINITY;
+
+	for (int steps = std::abs(targetX - x) + std::abs(targetY - y); steps > 0; steps--) {
+		if (nextX < nextY) {
+			x += stepX;
+			nextX += deltaX;
+		} else {
+			y += stepY;
+			nextY += deltaY;
+		}
+
+		if (x == targetX && y == targetY) {
+			return true;
+		}
+
+		if (tiles.IsSolid(x, y)) {
+			return false;
+		}
+	}
+
+	return true;
+}
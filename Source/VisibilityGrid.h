@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2019 Levi van Rheenen - All rights reserved
+ */
+
+#ifndef VISIBILITYGRID_H_
+#define VISIBILITYGRID_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TileMap.h"
+
+/**
+ * Which tiles can be seen from the center of a tile, usually the one of the
+ * player. The tiles in a region are tested once, by walking the line from
+ * the origin to the center of each tile through the grid, after which a
+ * visibility test is a single lookup.
+ */
+class VisibilityGrid {
+
+public:
+	/**
+	 * Tests the tiles within the region, clamped to the tile map, against
+	 * the solid tiles, but only if the origin, the tiles of the region or
+	 * the tile map changed. Returns whether it did. Tiles outside the
+	 * region are never visible.
+	 */
+	bool Update(const TileMap& tiles, int originX, int originY, const glm::vec2& lower, const glm::vec2& upper);
+
+	bool IsVisible(float x, float y) const;
+
+private:
+	static bool _HasLineOfSight(const TileMap& tiles, const glm::vec2& origin, int x, int y);
+
+	int _x = 0;
+	int _y = 0;
+	unsigned _width = 0;
+	unsigned _height = 0;
+	int _origin_x = -1;
+	int _origin_y = -1;
+	uint64_t _tiles_version = ~uint64_t(0);
+	std::vector<uint8_t> _visible;
+
+};
+
+#endif
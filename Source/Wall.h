@@ -9,30 +9,21 @@
 
 #include "Entity.h"
 #include "Image.h"
-#include "ShaderProgram.h"
 
+/**
+ * A solid tile. Walls have no body of their own, their colliders are
+ * merged by the TileMap of the level, and they are drawn by its
+ * TileRenderer.
+ */
 class Wall : public Entity {
 
 public:
-	Wall(unsigned x, unsigned y);
+	Wall(unsigned x, unsigned y, Type type = WALL);
 	virtual ~Wall() = default;
 
-	virtual void Render(const glm::ivec2& screenDimensions, const glm::vec3& cameraParams) const;
-
-protected:
-	b2BodyDef _CreateBody() const;
-	void _CreateFixture(std::shared_ptr<b2Body> body) const;
-
-private:
-	static void _PrepareRenderer();
-	static void _PreparePhysics();
-
-	static GLhandle _vao;
-	static GLhandle _vbo;
-	static bool _is_renderer_prepared;
+	void Respawn(unsigned x, unsigned y);
 
-	static b2PolygonShape _shape;
-	static bool _is_physics_prepared;
+	virtual void Render(LineBatch& batch) const {}
 };
 
 #endif
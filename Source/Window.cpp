@@ -8,6 +8,7 @@
 #include <GLFW/glfw3.h>
 
 #include "Error.h"
+#include "GLState.h"
 
 Window::__GLFW Window::_glfw;
 
@@ -77,8 +78,8 @@ Window::Window(EventListener *eventListener) :
 	}
 
 	glLineWidth(_width / 800.0f);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::SetBlend(true);
+	GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 void Window::Show(const Renderer& renderer) {